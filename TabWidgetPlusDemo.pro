@@ -6,21 +6,50 @@
 
 QT       += core gui
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 greaterThan(QT_MAJOR_VERSION, 4): CONFIG += c++11
 
 TARGET = TabWidgetPlusDemo
 TEMPLATE = app
 
+# TabWidgetPlus::stats() only collects timings in builds with
+# TABWIDGETPLUS_STATS defined (see tabwidgetstats.h); bench/ turns it
+# on.  The benchmarks and the fuzzer are separate projects in bench/
+# and fuzz/.
+
 
 SOURCES += main.cpp\
         mainwindow.cpp \
     tabwidgetplus.cpp \
-    formtabtester.cpp
+    formtabtester.cpp \
+    tabregistry.cpp \
+    lazytabpage.cpp \
+    virtualtabbar.cpp \
+    tabsearchpopup.cpp \
+    tabstressdriver.cpp \
+    tabwidgetstats.cpp \
+    tabpreviewcache.cpp \
+    tabcommandqueue.cpp \
+    tabactivationtracer.cpp \
+    tabgroup.cpp \
+    tabtimerthrottle.cpp \
+    tabmemoryreport.cpp
 
 HEADERS  += mainwindow.h \
     tabwidgetplus.h \
-    formtabtester.h
+    formtabtester.h \
+    tabregistry.h \
+    lazytabpage.h \
+    virtualtabbar.h \
+    tabsearchpopup.h \
+    tabstressdriver.h \
+    tabwidgetstats.h \
+    tabpreviewcache.h \
+    tabcommandqueue.h \
+    tabactivationtracer.h \
+    tabgroup.h \
+    tabtimerthrottle.h \
+    tabmemoryreport.h
 
 FORMS    += mainwindow.ui \
     formtabtester.ui
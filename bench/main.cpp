@@ -0,0 +1,41 @@
+#include "tabbenchmark.h"
+#include <QApplication>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    // Headless unless told otherwise ("-platform xcb" still wins).
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication a(argc, argv);
+
+    // "--trace <file>" saves the tab activation trace.  Exits non-zero
+    // if a check failed.
+    QTextStream out(stdout);
+    auto trace = a.arguments().indexOf("--trace");
+    auto traceFile = -1 == trace ? QString() : a.arguments().value(trace + 1);
+    std::vector<int> tabCounts = {10, 100, 1000, 10000, 100000};
+
+    // The churn run's leak checks are the one part that can fail.
+    auto passed = true;
+    out << TabBenchmark::churn(1000000, &passed) << "\n";
+    out.flush();
+
+    out << TabBenchmark::scaling(tabCounts) << "\n"
+        << TabBenchmark::operations(tabCounts) << "\n"
+        << TabBenchmark::startup(1000) << "\n"
+        << TabBenchmark::retitle(100, 60) << "\n"
+        << TabBenchmark::scrolling(50000, 120) << "\n"
+        << TabBenchmark::restore(5000) << "\n"
+        << TabBenchmark::filter(10000) << "\n"
+        << TabBenchmark::commandQueue(8, 100000) << "\n"
+        << TabBenchmark::activation(200, 500, traceFile) << "\n"
+        << TabBenchmark::groupMove(5000) << "\n"
+        << TabBenchmark::enumerate(10000, 1000) << "\n"
+        << TabBenchmark::eventDelivery(500, 2000) << "\n"
+        << TabBenchmark::asyncOpen(50, 20) << "\n"
+        << TabBenchmark::throttling(500, 2000) << "\n"
+        << TabBenchmark::memoryFootprint({1000, 10000, 50000});
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,972 @@
+#include "tabbenchmark.h"
+#include "tabactivationtracer.h"
+#include "tabcommandqueue.h"
+#include "tabgroup.h"
+#include "tabtimerthrottle.h"
+#include "tabwidgetplus.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QLabel>
+#include <QRegularExpression>
+#include <QTimer>
+#include <QTimerEvent>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <new>
+#include <random>
+#include <thread>
+
+namespace {
+
+std::atomic<std::size_t> allocationCount(0);
+std::atomic<std::size_t> deallocationCount(0);
+
+std::size_t liveAllocations()
+{
+    return allocationCount.load(std::memory_order_relaxed)
+           - deallocationCount.load(std::memory_order_relaxed);
+}
+
+//
+// Exposes the bookkeeping that TabWidgetPlus keeps to itself.
+//
+class ProbeTabWidget : public TabWidgetPlus
+{
+public:
+    std::size_t trackedTabs() const
+    {
+        return registry.size();
+    }
+
+    int destroyedReceivers() const
+    {
+        return receivers(SIGNAL(destroyed(QObject *)));
+    }
+};
+
+// Average cost in microseconds of one call, given the total elapsed time.
+QString perCall(qint64 nsecs, int calls)
+{
+    return QString::number(nsecs / 1000.0 / std::max(calls, 1), 'f', 3);
+}
+
+//
+// Collects one timing sample per call, plus the number of allocations
+// made between start() and stop().
+//
+class OperationTimer
+{
+public:
+    explicit OperationTimer(std::size_t expectedCalls)
+    {
+        samples.reserve(expectedCalls);
+    }
+
+    void start()
+    {
+        allocationsAtStart = allocationCount.load(std::memory_order_relaxed);
+        timer.start();
+    }
+
+    void stop()
+    {
+        samples.push_back(timer.nsecsElapsed());
+        allocations += allocationCount.load(std::memory_order_relaxed)
+                       - allocationsAtStart;
+    }
+
+    QString row(const QString &operation, int tabCount)
+    {
+        if (samples.empty()) {
+            return QString();
+        }
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [this](double fraction) {
+            auto index = static_cast<std::size_t>(fraction * (samples.size() - 1));
+            return QString::number(samples[index] / 1000.0, 'f', 3);
+        };
+        auto calls = static_cast<double>(samples.size());
+        return operation + "\t" + QString::number(tabCount)
+               + "\t" + QString::number(samples.size())
+               + "\t" + percentile(0.50) + "\t" + percentile(0.90)
+               + "\t" + percentile(0.99) + "\t" + percentile(1.0)
+               + "\t" + QString::number(allocations / calls, 'f', 2) + "\n";
+    }
+
+private:
+    QElapsedTimer timer;
+    std::vector<qint64> samples;
+    std::size_t allocationsAtStart = 0;
+    std::size_t allocations = 0;
+};
+
+// A page with some weight to it, for the startup comparison.
+QWidget *buildFormPage()
+{
+    auto page = new QWidget;
+    auto pageLayout = new QVBoxLayout(page);
+    for (auto i = 0; i < 20; ++i) {
+        pageLayout->addWidget(new QLabel("Field " + QString::number(i)));
+    }
+    return page;
+}
+
+// A page that redraws on every timer tick, standing in for a page
+// with an animation running.
+class AnimatedPage : public QWidget
+{
+public:
+    int frame = 0;
+
+protected:
+    void timerEvent(QTimerEvent *) override
+    {
+        ++frame;
+    }
+};
+
+//
+// The page filter as TabWidgetPlus had it before it turned events away
+// up front:  every event was timed, then checked.
+//
+class EveryEventFilter : public QObject
+{
+public:
+    TabWidgetStats::Histogram histogram;
+    quint64 tracked = 0;
+
+protected:
+    bool eventFilter(QObject *, QEvent *event) override
+    {
+        TabWidgetStats::Timer timer(histogram);
+        auto type = event->type();
+        if (QEvent::EnabledChange == type || QEvent::ToolTipChange == type) {
+            ++tracked;
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+//
+// Count every allocation in the program.  A relaxed atomic increment
+// costs next to nothing next to malloc itself.
+//
+void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (auto memory = std::malloc(0 == size ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    if (nullptr != memory) {
+        deallocationCount.fetch_add(1, std::memory_order_relaxed);
+        std::free(memory);
+    }
+}
+
+QString TabBenchmark::scaling(const std::vector<int> &tabCounts)
+{
+    QString result = "tabs\tadd(us)\thide(us)\tshow(us)\tstate(us)\n";
+    std::mt19937 random(12345);
+
+    for (auto tabCount : tabCounts) {
+        TabWidgetPlus tabWidget;
+        std::vector<QWidget *> pages;
+        pages.reserve(tabCount);
+
+        QElapsedTimer timer;
+        timer.start();
+        for (auto i = 0; i < tabCount; ++i) {
+            auto page = new QWidget;
+            pages.push_back(page);
+            tabWidget.addTab(page, "Item " + QString::number(i));
+        }
+        auto addNsecs = timer.nsecsElapsed();
+
+        // Hide every other tab so hidden and visible tabs interleave.
+        for (auto i = 0; i < tabCount; i += 2) {
+            tabWidget.hideTab(pages[i]);
+        }
+
+        // Hide one tab and show another, many times over.  A hidden
+        // page is picked for each show so every call does real work.
+        auto rounds = std::min(tabCount, 1000);
+        std::uniform_int_distribution<int> pick(0, tabCount - 1);
+        qint64 hideNsecs = 0;
+        qint64 showNsecs = 0;
+        for (auto i = 0; i < rounds; ++i) {
+            auto toHide = pages[pick(random)];
+            timer.restart();
+            tabWidget.hideTab(toHide);
+            hideNsecs += timer.nsecsElapsed();
+
+            auto toShow = pages[pick(random)];
+            timer.restart();
+            tabWidget.showTab(toShow);
+            showNsecs += timer.nsecsElapsed();
+        }
+
+        timer.restart();
+        auto hiddenSeen = 0;
+        for (auto page : pages) {
+            if (TabWidgetPlus::tabWidgetState::hidden == tabWidget.tabState(page)) {
+                ++hiddenSeen;
+            }
+        }
+        auto stateNsecs = timer.nsecsElapsed();
+        Q_UNUSED(hiddenSeen);
+
+        result += QString::number(tabCount) + "\t"
+                  + perCall(addNsecs, tabCount) + "\t"
+                  + perCall(hideNsecs, rounds) + "\t"
+                  + perCall(showNsecs, rounds) + "\t"
+                  + perCall(stateNsecs, tabCount) + "\n";
+    }
+    return result;
+}
+
+QString TabBenchmark::operations(const std::vector<int> &tabCounts)
+{
+    QString result = "operation\ttabs\tcalls\tp50(us)\tp90(us)\tp99(us)"
+                     "\tmax(us)\tallocs/call\n";
+    std::mt19937 random(54321);
+
+    for (auto tabCount : tabCounts) {
+        TabWidgetPlus tabWidget;
+        std::vector<QWidget *> pages;
+        pages.reserve(tabCount);
+        auto rounds = std::min(tabCount, 1000);
+
+        OperationTimer addTimer(tabCount);
+        for (auto i = 0; i < tabCount; ++i) {
+            auto page = new QWidget;
+            pages.push_back(page);
+            auto title = "Item " + QString::number(i);
+            addTimer.start();
+            tabWidget.addTab(page, title);
+            addTimer.stop();
+        }
+        result += addTimer.row("addTab", tabCount);
+
+        // Hide every other tab, so half of the bookkeeping is hidden.
+        std::vector<QWidget *> hiddenPages;
+        OperationTimer hideTimer(tabCount / 2 + 1);
+        for (auto i = 0; i < tabCount; i += 2) {
+            hideTimer.start();
+            tabWidget.hideTab(pages[i]);
+            hideTimer.stop();
+            hiddenPages.push_back(pages[i]);
+        }
+        result += hideTimer.row("hideTab", tabCount);
+
+        OperationTimer stateTimer(tabCount);
+        for (auto page : pages) {
+            stateTimer.start();
+            auto state = tabWidget.tabState(page);
+            stateTimer.stop();
+            Q_UNUSED(state);
+        }
+        result += stateTimer.row("tabState", tabCount);
+
+        // Show hidden pages in random order, then hide them again
+        // (untimed) so the mix stays the same for what follows.
+        std::shuffle(hiddenPages.begin(), hiddenPages.end(), random);
+        auto showCount = std::min<std::size_t>(rounds, hiddenPages.size());
+        OperationTimer showTimer(showCount);
+        for (std::size_t i = 0; i < showCount; ++i) {
+            showTimer.start();
+            tabWidget.showTab(hiddenPages[i]);
+            showTimer.stop();
+        }
+        for (std::size_t i = 0; i < showCount; ++i) {
+            tabWidget.hideTab(hiddenPages[i]);
+        }
+        result += showTimer.row("showTab", tabCount);
+
+        // Move a random visible tab to a random spot.
+        OperationTimer moveTimer(rounds);
+        for (auto i = 0; i < rounds && tabWidget.count() > 1; ++i) {
+            std::uniform_int_distribution<int> pick(0, tabWidget.count() - 1);
+            auto from = pick(random);
+            auto to = pick(random);
+            auto page = tabWidget.widget(from);
+            auto title = tabWidget.tabText(from);
+            moveTimer.start();
+            tabWidget.removeTab(from);
+            tabWidget.insertTab(to, page, title);
+            moveTimer.stop();
+        }
+        result += moveTimer.row("reorder", tabCount);
+
+        // Delete pages while their tabs are hidden.
+        auto deleteCount = std::min<std::size_t>(rounds, hiddenPages.size());
+        OperationTimer deleteTimer(deleteCount);
+        for (std::size_t i = 0; i < deleteCount; ++i) {
+            deleteTimer.start();
+            delete hiddenPages[i];
+            deleteTimer.stop();
+        }
+        result += deleteTimer.row("deleteHidden", tabCount);
+    }
+    return result;
+}
+
+QString TabBenchmark::churn(int cycles, bool *passed)
+{
+    ProbeTabWidget tabWidget;
+    const auto longLivedTabs = 10;
+    for (auto i = 0; i < longLivedTabs; ++i) {
+        tabWidget.addTab(new QWidget, "Fixed " + QString::number(i));
+    }
+    auto receiversBefore = tabWidget.destroyedReceivers();
+
+    // Let Qt fill its caches before taking the baseline.
+    const auto warmupCycles = std::min(cycles, 1000);
+    std::size_t baseline = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (auto i = 0; i < cycles; ++i) {
+        if (i == warmupCycles) {
+            baseline = liveAllocations();
+        }
+        auto page = new QWidget;
+        tabWidget.addTab(page, "Churn");
+        if (0 != (i % 2)) {
+            tabWidget.hideTab(page);
+        }
+        delete page;
+    }
+    auto elapsed = timer.nsecsElapsed();
+    if (cycles <= warmupCycles) {
+        baseline = liveAllocations();
+    }
+
+    auto growth = static_cast<qint64>(liveAllocations())
+                  - static_cast<qint64>(baseline);
+    auto result = "cycles: " + QString::number(cycles)
+                  + "\nus/cycle: " + QString::number(elapsed / 1000.0 / std::max(cycles, 1), 'f', 3)
+                  + "\ntracked tabs: " + QString::number(tabWidget.trackedTabs())
+                  + " (expected " + QString::number(longLivedTabs) + ")"
+                  + "\nreceivers of destroyed(): " + QString::number(tabWidget.destroyedReceivers())
+                  + " (expected " + QString::number(receiversBefore) + ")"
+                  + "\nlive allocation growth after warmup: " + QString::number(growth) + "\n";
+
+    auto ok = true;
+    auto check = [&result, &ok](bool good, const QString &what) {
+        if (!good) {
+            result += "FAILED: " + what + "\n";
+            ok = false;
+        }
+    };
+    check(static_cast<std::size_t>(longLivedTabs) == tabWidget.trackedTabs(),
+          "churned tabs are still tracked");
+    check(receiversBefore == tabWidget.destroyedReceivers(),
+          "connections were left behind");
+    check(growth * 1000 < std::max(cycles - warmupCycles, 1000),
+          "live allocations grew with the cycles");
+    if (nullptr != passed) {
+        *passed = *passed && ok;
+    }
+    return result;
+}
+
+QString TabBenchmark::startup(int tabCount)
+{
+    QString result = "mode\ttabs\tms\tlive allocations\n";
+    for (auto lazy : {false, true}) {
+        auto before = liveAllocations();
+        QElapsedTimer timer;
+        timer.start();
+        {
+            TabWidgetPlus tabWidget;
+            for (auto i = 0; i < tabCount; ++i) {
+                auto title = "Item " + QString::number(i);
+                if (lazy) {
+                    tabWidget.addLazyTab(buildFormPage, title);
+                } else {
+                    tabWidget.addTab(buildFormPage(), title);
+                }
+            }
+            auto elapsed = timer.elapsed();
+            auto live = static_cast<qint64>(liveAllocations())
+                        - static_cast<qint64>(before);
+            result += QString(lazy ? "lazy" : "eager") + "\t"
+                      + QString::number(tabCount) + "\t"
+                      + QString::number(elapsed) + "\t"
+                      + QString::number(live) + "\n";
+        }
+    }
+    return result;
+}
+
+QString TabBenchmark::retitle(int tabCount, int frames)
+{
+    QString result = "mode\ttabs\tframes\tms\tavoided relayouts\n";
+    const auto updatesPerFrame = 10;
+    for (auto coalesce : {false, true}) {
+        TabWidgetPlus tabWidget;
+        tabWidget.setCoalescedUpdates(coalesce);
+        std::vector<QWidget *> pages;
+        for (auto i = 0; i < tabCount; ++i) {
+            pages.push_back(new QWidget);
+            tabWidget.addTab(pages.back(), "Item " + QString::number(i));
+        }
+        tabWidget.show();
+        QCoreApplication::processEvents();
+
+        QElapsedTimer timer;
+        timer.start();
+        auto counter = 0;
+        for (auto frame = 0; frame < frames; ++frame) {
+            for (auto update = 0; update < updatesPerFrame; ++update) {
+                ++counter;
+                for (auto page : pages) {
+                    page->setWindowTitle("Live " + QString::number(counter));
+                }
+            }
+            QCoreApplication::processEvents();
+        }
+        result += QString(coalesce ? "coalesced" : "immediate") + "\t"
+                  + QString::number(tabCount) + "\t"
+                  + QString::number(frames) + "\t"
+                  + QString::number(timer.elapsed()) + "\t"
+                  + QString::number(tabWidget.avoidedRelayouts()) + "\n";
+    }
+    return result;
+}
+
+QString TabBenchmark::scrolling(int tabCount, int frames)
+{
+    QString result = "mode\ttabs\tfill(ms)\tframe(ms)\n";
+    for (auto virtualized : {false, true}) {
+        TabWidgetPlus tabWidget;
+        tabWidget.setVirtualized(virtualized);
+        tabWidget.resize(1280, 800);
+        tabWidget.show();
+
+        QElapsedTimer timer;
+        timer.start();
+        {
+            TabWidgetPlus::BatchScope batch(&tabWidget);
+            for (auto i = 0; i < tabCount; ++i) {
+                tabWidget.addTab(new QWidget, "Host " + QString::number(i));
+            }
+        }
+        QCoreApplication::processEvents();
+        auto fillMsecs = timer.elapsed();
+
+        timer.restart();
+        for (auto frame = 0; frame < frames; ++frame) {
+            tabWidget.setCurrentIndex((frame * 7) % tabCount);
+            tabWidget.repaint();
+        }
+        auto frameMsecs = timer.nsecsElapsed() / 1e6 / std::max(frames, 1);
+
+        result += QString(virtualized ? "virtual" : "plain") + "\t"
+                  + QString::number(tabCount) + "\t"
+                  + QString::number(fillMsecs) + "\t"
+                  + QString::number(frameMsecs, 'f', 3) + "\n";
+    }
+    return result;
+}
+
+QString TabBenchmark::restore(int tabCount)
+{
+    QString result = "mode\ttabs\ttime(ms)\n";
+    auto makePage = [](int i) {
+        auto page = new QWidget;
+        page->setObjectName("page" + QString::number(i));
+        return page;
+    };
+
+    QByteArray layout;
+    {
+        TabWidgetPlus tabWidget;
+        QElapsedTimer timer;
+        timer.start();
+        for (auto i = 0; i < tabCount; ++i) {
+            auto page = makePage(i);
+            tabWidget.addTab(page, "Tab " + QString::number(i));
+            if (0 != i % 2) {
+                tabWidget.hideTab(page);
+            }
+        }
+        result += "one by one\t" + QString::number(tabCount) + "\t"
+                  + QString::number(timer.elapsed()) + "\n";
+        layout = tabWidget.saveLayout();
+    }
+    {
+        TabWidgetPlus tabWidget;
+        QElapsedTimer timer;
+        timer.start();
+        tabWidget.restoreLayout(layout, [ = ](const QString & name) {
+            return makePage(name.mid(4).toInt());
+        });
+        result += "restoreLayout\t" + QString::number(tabCount) + "\t"
+                  + QString::number(timer.elapsed()) + "\n";
+    }
+    return result;
+}
+
+QString TabBenchmark::filter(int tabCount)
+{
+    QString result = "mode\ttabs\tnarrow(ms)\tclear(ms)\n";
+    for (auto useFilter : {false, true}) {
+        TabWidgetPlus tabWidget;
+        std::vector<QWidget *> pages;
+        for (auto i = 0; i < tabCount; ++i) {
+            pages.push_back(new QWidget);
+            tabWidget.addTab(pages.back(), "host-" + QString::number(i));
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        if (useFilter) {
+            tabWidget.setFilter(QRegularExpression("0$"));
+        } else {
+            for (auto i = 0; i < tabCount; ++i) {
+                if (0 != i % 10) {
+                    tabWidget.hideTab(pages[i]);
+                }
+            }
+        }
+        auto narrowMsecs = timer.restart();
+        if (useFilter) {
+            tabWidget.clearFilter();
+        } else {
+            for (auto page : pages) {
+                tabWidget.showTab(page);
+            }
+        }
+        auto clearMsecs = timer.elapsed();
+
+        result += QString(useFilter ? "setFilter" : "per tab") + "\t"
+                  + QString::number(tabCount) + "\t"
+                  + QString::number(narrowMsecs) + "\t"
+                  + QString::number(clearMsecs) + "\n";
+    }
+    return result;
+}
+
+QString TabBenchmark::commandQueue(int producers, int commandsPerProducer)
+{
+    const auto tabsPerProducer = 64;
+    auto total = producers * commandsPerProducer;
+    QString result = "mode\tthreads\tcommands\ttime(ms)\tcommands/s"
+                     "\tp50(us)\tp99(us)\tcoalesced\n";
+
+    for (auto useQueue : {false, true}) {
+        TabWidgetPlus tabWidget;
+        auto queue = tabWidget.commandQueue();
+        std::vector<QWidget *> pages;
+        std::vector<QString> keys;
+        for (auto i = 0; i < producers * tabsPerProducer; ++i) {
+            keys.push_back("host-" + QString::number(i));
+            pages.push_back(new QWidget);
+            tabWidget.addTab(pages.back(), keys.back());
+            queue->bind(keys.back(), pages.back());
+        }
+
+        std::atomic<int> finished(0);
+        QElapsedTimer timer;
+        timer.start();
+        std::vector<std::thread> threads;
+        for (auto producer = 0; producer < producers; ++producer) {
+            threads.emplace_back([ =, &tabWidget, &pages, &keys, &finished]() {
+                std::mt19937 rng(producer + 1);
+                for (auto i = 0; i < commandsPerProducer; ++i) {
+                    auto tab = producer * tabsPerProducer + rng() % tabsPerProducer;
+                    auto choice = rng() % 4;
+                    if (useQueue) {
+                        const auto &key = keys[tab];
+                        switch (choice) {
+                        case 0:
+                            queue->postHide(key);
+                            break;
+                        case 1:
+                            queue->postShow(key);
+                            break;
+                        case 2:
+                            queue->postRetitle(key, key + " " + QString::number(i));
+                            break;
+                        default:
+                            queue->postSetEnabled(key, 0 != i % 2);
+                            break;
+                        }
+                        continue;
+                    }
+                    auto page = pages[tab];
+                    switch (choice) {
+                    case 0:
+                        QMetaObject::invokeMethod(&tabWidget, "hideTab", Qt::QueuedConnection,
+                                                  Q_ARG(QWidget *, page));
+                        break;
+                    case 1:
+                        QMetaObject::invokeMethod(&tabWidget, "showTab", Qt::QueuedConnection,
+                                                  Q_ARG(QWidget *, page));
+                        break;
+                    case 2:
+                        QMetaObject::invokeMethod(page, "setWindowTitle", Qt::QueuedConnection,
+                                                  Q_ARG(QString, keys[tab] + " " + QString::number(i)));
+                        break;
+                    default:
+                        QMetaObject::invokeMethod(page, "setEnabled", Qt::QueuedConnection,
+                                                  Q_ARG(bool, 0 != i % 2));
+                        break;
+                    }
+                }
+                ++finished;
+            });
+        }
+
+        // Everything a thread posted is in the event queue before it
+        // counts itself finished, so one more pass picks up the rest.
+        while (finished.load() < producers
+                || (useQueue && queue->stats().drained < static_cast<quint64>(total))) {
+            QCoreApplication::processEvents();
+        }
+        QCoreApplication::processEvents();
+        auto msecs = std::max<qint64>(timer.elapsed(), 1);
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        auto row = QString(useQueue ? "queue" : "invokeMethod") + "\t"
+                   + QString::number(producers) + "\t" + QString::number(total) + "\t"
+                   + QString::number(msecs) + "\t"
+                   + QString::number(total * 1000.0 / msecs, 'f', 0) + "\t";
+        if (useQueue) {
+            auto stats = queue->stats();
+            row += QString::number(stats.latency.percentile(0.5) / 1000.0, 'f', 1) + "\t"
+                   + QString::number(stats.latency.percentile(0.99) / 1000.0, 'f', 1) + "\t"
+                   + QString::number(stats.coalesced);
+        } else {
+            row += "-\t-\t-";
+        }
+        result += row + "\n";
+    }
+    return result;
+}
+
+QString TabBenchmark::activation(int tabCount, int switches, const QString &traceFile)
+{
+    TabWidgetPlus tabWidget;
+    tabWidget.resize(1024, 768);
+    for (auto i = 0; i < tabCount; ++i) {
+        auto title = "Page " + QString::number(i);
+        if (0 == i % 2) {
+            tabWidget.addTab(buildFormPage(), title);
+        } else {
+            tabWidget.addLazyTab(buildFormPage, title);
+        }
+    }
+    tabWidget.show();
+    QCoreApplication::processEvents();
+
+    tabWidget.setActivationTracing(true);
+    std::mt19937 rng(1);
+    for (auto i = 0; i < switches; ++i) {
+        tabWidget.setCurrentIndex(rng() % tabWidget.count());
+        QCoreApplication::processEvents();
+        if (0 == i % 8 && 1 < tabWidget.count()) {
+            auto page = tabWidget.widget(rng() % tabWidget.count());
+            tabWidget.hideTab(page);
+            QCoreApplication::processEvents();
+            tabWidget.showTab(page);
+            QCoreApplication::processEvents();
+        }
+    }
+
+    auto tracer = tabWidget.activationTracer();
+    auto result = tracer->report();
+    if (!traceFile.isEmpty()) {
+        result += tracer->saveChromeTrace(traceFile)
+                  ? "trace saved to " + traceFile + "\n"
+                  : "could not write " + traceFile + "\n";
+    }
+    return result;
+}
+
+QString TabBenchmark::groupMove(int tabCount)
+{
+    QString result = "mode\ttabs\tms\tpages built\n";
+    for (auto useGroup : {false, true}) {
+        TabWidgetPlus source;
+        TabWidgetPlus target;
+        TabGroup group;
+        if (useGroup) {
+            group.addView(&source);
+            group.addView(&target);
+        }
+        std::vector<QWidget *> pages;
+        for (auto i = 0; i < tabCount; ++i) {
+            pages.push_back(buildFormPage());
+            source.addTab(pages.back(), "Item " + QString::number(i));
+            if (0 != i % 2) {
+                source.hideTab(pages.back());
+            }
+        }
+
+        auto built = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (auto i = 0; i < tabCount; ++i) {
+            auto page = pages[i];
+            if (useGroup) {
+                group.moveTab(page, &target);
+                continue;
+            }
+            auto hidden = TabWidgetPlus::tabWidgetState::hidden == source.tabState(page);
+            auto title = page->windowTitle();
+            if (!hidden) {
+                title = source.tabText(source.indexOf(page));
+            }
+            delete page;
+            page = buildFormPage();
+            ++built;
+            target.addTab(page, title);
+            if (hidden) {
+                target.hideTab(page);
+            }
+        }
+        result += QString(useGroup ? "moveTab" : "rebuild") + "\t"
+                  + QString::number(tabCount) + "\t"
+                  + QString::number(timer.elapsed()) + "\t"
+                  + QString::number(built) + "\n";
+    }
+    return result;
+}
+
+QString TabBenchmark::enumerate(int tabCount, int polls)
+{
+    QString result = "mode\ttabs\tus/poll\tallocations/poll\n";
+    TabWidgetPlus tabWidget;
+    std::vector<QWidget *> pages;
+    for (auto i = 0; i < tabCount; ++i) {
+        pages.push_back(new QWidget);
+        tabWidget.addTab(pages.back(), "Item " + QString::number(i));
+    }
+    for (auto i = 0; i < tabCount; i += 4) {
+        tabWidget.hideTab(pages[i]);
+    }
+
+    const char *modes[] = {"tabState", "forEachTab", "hiddenTabs", "generation"};
+    for (auto mode = 0; mode < 4; ++mode) {
+        auto visible = 0;
+        quint64 seen = ~quint64(0);
+        auto allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+        QElapsedTimer timer;
+        timer.start();
+        for (auto poll = 0; poll < polls; ++poll) {
+            if (0 == poll % 10) {
+                // Something changed since the last poll.
+                auto page = pages[(poll / 10) % tabCount];
+                if (TabWidgetPlus::tabWidgetState::hidden == tabWidget.tabState(page)) {
+                    tabWidget.showTab(page);
+                } else {
+                    tabWidget.hideTab(page);
+                }
+            }
+            switch (mode) {
+            case 0:
+                for (auto index = 0; index < tabWidget.count(); ++index) {
+                    auto state = tabWidget.tabState(tabWidget.widget(index));
+                    visible += TabWidgetPlus::tabWidgetState::visible == state ? 1 : 0;
+                }
+                break;
+            case 1:
+                tabWidget.forEachTab([&visible](const TabWidgetPlus::TabInfo & tab) {
+                    visible += TabWidgetPlus::tabWidgetState::visible == tab.state ? 1 : 0;
+                });
+                break;
+            case 2:
+                for (auto page : tabWidget.hiddenTabs()) {
+                    visible += nullptr == page ? 0 : 1;
+                }
+                break;
+            case 3:
+                if (seen != tabWidget.tabsGeneration()) {
+                    seen = tabWidget.tabsGeneration();
+                    tabWidget.forEachTab([&visible](const TabWidgetPlus::TabInfo & tab) {
+                        visible += TabWidgetPlus::tabWidgetState::visible == tab.state ? 1 : 0;
+                    });
+                }
+                break;
+            }
+        }
+        auto elapsed = timer.nsecsElapsed();
+        auto allocations = allocationCount.load(std::memory_order_relaxed)
+                           - allocationsBefore;
+        result += QString(modes[mode]) + "\t" + QString::number(tabCount) + "\t"
+                  + perCall(elapsed, polls) + "\t"
+                  + QString::number(double(allocations) / polls, 'f', 2) + "\n";
+        // Keep the walks from being optimized away.
+        if (visible < 0) {
+            result += "\n";
+        }
+    }
+    return result;
+}
+
+QString TabBenchmark::eventDelivery(int pageCount, int frames)
+{
+    QString result = "mode\tpages\tns/event\n";
+    const char *modes[] = {"no filter", "every event", "TabWidgetPlus"};
+    for (auto mode = 0; mode < 3; ++mode) {
+        EveryEventFilter everyEvent;
+        QTabWidget plain;
+        TabWidgetPlus plus;
+        QTabWidget *tabWidget = 2 == mode ? &plus : &plain;
+        std::vector<AnimatedPage *> pages;
+        for (auto i = 0; i < pageCount; ++i) {
+            pages.push_back(new AnimatedPage);
+            tabWidget->addTab(pages.back(), "Page " + QString::number(i));
+            if (1 == mode) {
+                pages.back()->installEventFilter(&everyEvent);
+            }
+        }
+
+        QTimerEvent tick(1);
+        QElapsedTimer timer;
+        timer.start();
+        for (auto frame = 0; frame < frames; ++frame) {
+            for (auto page : pages) {
+                QCoreApplication::sendEvent(page, &tick);
+            }
+        }
+        auto elapsed = timer.nsecsElapsed();
+        result += QString(modes[mode]) + "\t" + QString::number(pageCount) + "\t"
+                  + QString::number(double(elapsed) / (double(pageCount) * frames), 'f', 1)
+                  + "\n";
+    }
+    return result;
+}
+
+QString TabBenchmark::asyncOpen(int tabCount, int loadMsecs)
+{
+    QString result = "mode\ttabs\topen(ms)\tall built(ms)\tworst stall(ms)\n";
+    auto load = [loadMsecs]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(loadMsecs));
+        return QVariant(loadMsecs);
+    };
+    for (auto async : {false, true}) {
+        TabWidgetPlus tabWidget;
+        QElapsedTimer timer;
+        timer.start();
+        for (auto i = 0; i < tabCount; ++i) {
+            auto title = "Host " + QString::number(i);
+            if (async) {
+                tabWidget.addAsyncTab(load, [](const QVariant &) {
+                    return buildFormPage();
+                }, title);
+            } else {
+                load();
+                tabWidget.addTab(buildFormPage(), title);
+            }
+        }
+        auto openMsecs = timer.elapsed();
+
+        auto allBuilt = [&tabWidget]() {
+            auto built = true;
+            tabWidget.forEachTab([&built](const TabWidgetPlus::TabInfo & tab) {
+                built = built && TabWidgetPlus::tabWidgetState::unmaterialized != tab.state;
+            });
+            return built;
+        };
+        // Opening blocks the GUI too, so it counts as a stall.
+        qint64 worstStall = openMsecs;
+        QElapsedTimer turn;
+        while (!allBuilt()) {
+            turn.start();
+            QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+            worstStall = std::max(worstStall, turn.elapsed());
+        }
+        result += QString(async ? "async" : "GUI thread") + "\t"
+                  + QString::number(tabCount) + "\t"
+                  + QString::number(openMsecs) + "\t"
+                  + QString::number(timer.elapsed()) + "\t"
+                  + QString::number(worstStall) + "\n";
+    }
+    return result;
+}
+
+QString TabBenchmark::throttling(int pageCount, int msecs)
+{
+    QString result = "mode\tpages\tcpu(ms)\tticks\n";
+    for (auto throttled : {false, true}) {
+        TabWidgetPlus tabWidget;
+        quint64 ticks = 0;
+        for (auto i = 0; i < pageCount; ++i) {
+            auto page = new QWidget;
+            auto timer = new QTimer(page);
+            QObject::connect(timer, &QTimer::timeout, page, [page, &ticks]() {
+                ++ticks;
+                page->update();
+            });
+            timer->start(16);
+            tabWidget.addTab(page, "Chart " + QString::number(i));
+        }
+        if (throttled) {
+            new TabTimerThrottle(&tabWidget);
+        }
+        tabWidget.show();
+
+        QEventLoop loop;
+        QTimer::singleShot(msecs, &loop, &QEventLoop::quit);
+        auto cpuStart = std::clock();
+        loop.exec();
+        auto cpuMsecs = (std::clock() - cpuStart) * 1000.0 / CLOCKS_PER_SEC;
+        result += QString(throttled ? "throttled" : "full rate") + "\t"
+                  + QString::number(pageCount) + "\t"
+                  + QString::number(cpuMsecs, 'f', 0) + "\t"
+                  + QString::number(ticks) + "\n";
+    }
+    return result;
+}
+
+QString TabBenchmark::memoryFootprint(const std::vector<int> &tabCounts)
+{
+    QString result = "tabs\toverhead(B/tab)\tregistry(B/tab)\tpages(KB)\tms/report\n";
+    for (auto tabCount : tabCounts) {
+        TabWidgetPlus tabWidget;
+        std::vector<QWidget *> pages;
+        for (auto i = 0; i < tabCount; ++i) {
+            auto title = "Item " + QString::number(i);
+            if (0 == i % 4) {
+                auto index = tabWidget.addLazyTab(buildFormPage, title);
+                pages.push_back(tabWidget.widget(index));
+                if (i < 40) {
+                    static_cast<LazyTabPage *>(pages.back())->materialize();
+                }
+            } else {
+                pages.push_back(new QWidget);
+                tabWidget.addTab(pages.back(), title);
+            }
+        }
+        for (auto i = 0; i < tabCount; i += 3) {
+            tabWidget.hideTab(pages[i]);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        auto report = tabWidget.memoryReport();
+        auto elapsed = timer.nsecsElapsed();
+        result += QString::number(tabCount) + "\t"
+                  + QString::number(report.overheadPerTab(), 'f', 1) + "\t"
+                  + QString::number(double(report.overhead.registryBytes) / tabCount, 'f', 1) + "\t"
+                  + QString::number(report.pageBytes() / 1024) + "\t"
+                  + QString::number(elapsed / 1e6, 'f', 3) + "\n";
+    }
+    return result;
+}
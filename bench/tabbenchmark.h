@@ -0,0 +1,220 @@
+#ifndef TABBENCHMARK_H
+#define TABBENCHMARK_H
+
+#include <QString>
+#include <vector>
+
+/**
+ * @brief Headless timing runs for TabWidgetPlus.
+ *
+ * Each run builds its own (never shown) TabWidgetPlus, so these can be
+ * started from the command line with "-platform offscreen" and no GUI.
+ * Allocations are counted by replacing the global operator new in this
+ * module, so they include everything Qt allocates on our behalf.
+ */
+class TabBenchmark
+{
+public:
+    /**
+     * @brief Time addTab/hideTab/showTab/tabState at growing tab counts.
+     *
+     * Half of the tabs are hidden before timing starts, so the hidden
+     * bookkeeping is as large as the visible tab bar.
+     *
+     * @param tabCounts The tab counts to measure, one row per count.
+     * @return A plain text table with the cost of each call in microseconds.
+     */
+    static QString scaling(const std::vector<int> &tabCounts);
+
+    /**
+     * @brief Per-call latency percentiles and allocations for each operation.
+     *
+     * For every tab count this times addTab, hideTab, showTab, tabState,
+     * reordering a visible tab, and deleting a page while its tab is
+     * hidden.  Every call is timed on its own.
+     *
+     * @param tabCounts The tab counts to measure.
+     * @return A plain text table, one row per operation and tab count.
+     */
+    static QString operations(const std::vector<int> &tabCounts);
+
+    /**
+     * @brief Create and delete tabs over and over, watching for leaks.
+     *
+     * Each cycle adds a page, hides every other one, and deletes it.
+     * After the run the tab widget should track only its long-lived
+     * tabs, hold no extra connections, and the number of live
+     * allocations should be where it was after warming up.
+     *
+     * Each of those is checked:  live allocations may grow by less
+     * than one per thousand cycles (Qt's own caches), anything more is
+     * a per-tab leak.
+     *
+     * @param cycles Number of create/delete cycles.
+     * @param passed Set to false if any check failed.
+     * @return A plain text report, with a FAILED line per failed check.
+     */
+    static QString churn(int cycles, bool *passed = nullptr);
+
+    /**
+     * @brief Compare building every page up front with addLazyTab().
+     *
+     * Each page is a small form of labels, standing in for a real page.
+     *
+     * @param tabCount Number of tabs to open.
+     * @return A plain text report with time and live allocations per mode.
+     */
+    static QString startup(int tabCount);
+
+    /**
+     * @brief Retitle every tab many times per frame, with and without
+     * coalesced updates.
+     *
+     * The tab widget is shown for this run, since QTabBar only lays
+     * itself out while it is visible.
+     *
+     * @param tabCount Number of tabs, all retitled each frame.
+     * @param frames Number of event loop turns to run.
+     * @return A plain text report with time and skipped updates per mode.
+     */
+    static QString retitle(int tabCount, int frames);
+
+    /**
+     * @brief Scroll through a shown tab bar, plain and virtualized.
+     *
+     * Each frame makes the next tab current (which scrolls the bar to
+     * it) and repaints the tab widget synchronously.
+     *
+     * @param tabCount Number of tabs in the bar.
+     * @param frames Number of frames to time.
+     * @return A plain text report with fill time and time per frame.
+     */
+    static QString scrolling(int tabCount, int frames);
+
+    /**
+     * @brief Rebuild a workspace with every other tab hidden, first by
+     * calling addTab()/hideTab() for each tab, then with restoreLayout().
+     *
+     * @param tabCount Number of tabs in the workspace.
+     * @return A plain text report with the time for each way.
+     */
+    static QString restore(int tabCount);
+
+    /**
+     * @brief Narrow a tab bar down to every tenth tab and back again,
+     * with hideTab()/showTab() per tab and then with setFilter().
+     *
+     * @param tabCount Number of tabs.
+     * @return A plain text report with the time for each way.
+     */
+    static QString filter(int tabCount);
+
+    /**
+     * @brief Drive a tab widget from worker threads, through
+     * QMetaObject::invokeMethod() per call and through the command queue.
+     *
+     * Each producer thread owns its own set of tabs and sends a random
+     * mix of hide, show, retitle and enable requests for them.
+     *
+     * @param producers Number of producer threads.
+     * @param commandsPerProducer Requests sent by each thread.
+     * @return A plain text report with throughput, and for the queue
+     *         the post-to-applied latency and how many commands folded.
+     */
+    static QString commandQueue(int producers, int commandsPerProducer);
+
+    /**
+     * @brief Switch between eager and lazy form pages in a shown tab
+     * widget, and hide/show tabs, with activation tracing on.
+     *
+     * @param tabCount Number of tabs (half of them lazy).
+     * @param switches Number of tab switches.
+     * @param traceFile If not empty, where to save the Chrome trace.
+     * @return The tracer's report.
+     */
+    static QString activation(int tabCount, int switches, const QString &traceFile);
+
+    /**
+     * @brief Move every tab from one window's tab widget to another's,
+     * by deleting and rebuilding each page, then with TabGroup::moveTab().
+     *
+     * Every other tab is hidden, and every page is a built form page.
+     *
+     * @param tabCount Number of tabs moved.
+     * @return A plain text report with the time for each way.
+     */
+    static QString groupMove(int tabCount);
+
+    /**
+     * @brief Poll the state of every tab, the way a status bar would.
+     *
+     * Compares tabState() on each widget (which only reaches the
+     * visible tabs), forEachTab(), walking hiddenTabs(), and skipping
+     * the walk while tabsGeneration() is unchanged.  A quarter of the
+     * tabs are hidden, and one tab is hidden or shown every tenth poll.
+     *
+     * @param tabCount Number of tabs.
+     * @param polls Number of polls per mode.
+     * @return A plain text report with time and allocations per poll.
+     */
+    static QString enumerate(int tabCount, int polls);
+
+    /**
+     * @brief Cost of delivering events to animated pages.
+     *
+     * Each frame sends every page a timer event, the way a running
+     * animation does.  Pages sit in a plain QTabWidget (no filter), in
+     * a QTabWidget with a filter that does what TabWidgetPlus's page
+     * filter used to do for every event (time it, then check its type),
+     * and in a TabWidgetPlus.
+     *
+     * @param pageCount Number of pages.
+     * @param frames Number of frames.
+     * @return A plain text report with the time per delivered event.
+     */
+    static QString eventDelivery(int pageCount, int frames);
+
+    /**
+     * @brief Open many tabs whose pages need slow data loading, built
+     * on the GUI thread before addTab() and then with addAsyncTab().
+     *
+     * Loading is simulated with a sleep of 'loadMsecs' per page, and
+     * each page is a form page.  For the asynchronous run the event
+     * loop is turned until every visible page is built, and the
+     * longest single turn is reported as the worst GUI stall.
+     *
+     * @param tabCount Number of tabs opened at once.
+     * @param loadMsecs Simulated data loading time per page.
+     * @return A plain text report with time to open, time until every
+     *         page is built, and the worst stall, per mode.
+     */
+    static QString asyncOpen(int tabCount, int loadMsecs);
+
+    /**
+     * @brief CPU used by a shown tab widget full of ticking pages, at
+     * full rate and with a TabTimerThrottle.
+     *
+     * Each page has a 16 ms QTimer that does a little work and asks
+     * for a repaint, like a live chart.
+     *
+     * @param pageCount Number of pages.
+     * @param msecs How long to run the event loop for each mode.
+     * @return A plain text report with CPU time and timer ticks per mode.
+     */
+    static QString throttling(int pageCount, int msecs);
+
+    /**
+     * @brief TabWidgetPlus's own memory per tab, and the cost of a
+     * memoryReport(), as the number of tabs grows.
+     *
+     * Every fourth tab is a lazy form page (only the first few are
+     * built) and every third tab is hidden.  The overhead per tab
+     * should stay about the same for every size.
+     *
+     * @param tabCounts Number of tabs for each run.
+     * @return A plain text report with overhead and report time per run.
+     */
+    static QString memoryFootprint(const std::vector<int> &tabCounts);
+};
+
+#endif // TABBENCHMARK_H
@@ -0,0 +1,53 @@
+#-------------------------------------------------
+#
+# Headless timing runs for TabWidgetPlus (see tabbenchmark.h):
+#
+#   qmake && make
+#   ./tabbench [--trace activation.json]
+#
+# It runs on the offscreen platform unless QT_QPA_PLATFORM says
+# otherwise.  tabbenchmark.cpp replaces the global operator new and
+# delete to count allocations, which is why the benchmarks live in a
+# program of their own rather than in the demo.
+#
+#-------------------------------------------------
+
+QT       += core gui widgets concurrent
+CONFIG   += c++11 console
+CONFIG   -= app_bundle
+
+TARGET = tabbench
+TEMPLATE = app
+INCLUDEPATH += ..
+
+# Collect TabWidgetPlus::stats() (see tabwidgetstats.h).
+DEFINES += TABWIDGETPLUS_STATS
+
+SOURCES += main.cpp \
+    tabbenchmark.cpp \
+    ../tabwidgetplus.cpp \
+    ../tabregistry.cpp \
+    ../lazytabpage.cpp \
+    ../virtualtabbar.cpp \
+    ../tabsearchpopup.cpp \
+    ../tabwidgetstats.cpp \
+    ../tabpreviewcache.cpp \
+    ../tabcommandqueue.cpp \
+    ../tabactivationtracer.cpp \
+    ../tabgroup.cpp \
+    ../tabtimerthrottle.cpp \
+    ../tabmemoryreport.cpp
+
+HEADERS += tabbenchmark.h \
+    ../tabwidgetplus.h \
+    ../tabregistry.h \
+    ../lazytabpage.h \
+    ../virtualtabbar.h \
+    ../tabsearchpopup.h \
+    ../tabwidgetstats.h \
+    ../tabpreviewcache.h \
+    ../tabcommandqueue.h \
+    ../tabactivationtracer.h \
+    ../tabgroup.h \
+    ../tabtimerthrottle.h \
+    ../tabmemoryreport.h
@@ -1,8 +1,9 @@
 #include "formtabtester.h"
+#include "tabstressdriver.h"
 #include "tabwidgetplus.h"
 #include "ui_formtabtester.h"
+#include <QMessageBox>
 #include <QTimer>
-#include <QtGlobal>
 #include <assert.h>
 
 FormTabTester::FormTabTester(QWidget *parent)
@@ -52,55 +53,61 @@ void FormTabTester::createTab()
     auto title = "Item " + QString::number(nextTabNumber++);
     tabWidget->addTab(button, title);
 
-    // Now, track the mapping of title to object, and add the title
-    // to the list box for future use (and select it).
-    tabInfo[title.toStdString()] = button;
-    ui->listWidget->addItem(title);
+    // Now, add the title to the list box for future use (and select
+    // it), remembering the tab by its ID rather than its widget.
+    auto item = new QListWidgetItem(title);
+    item->setData(Qt::UserRole, tabWidget->tabId(button));
+    ui->listWidget->addItem(item);
     ui->listWidget->setCurrentRow(ui->listWidget->count() - 1);
 }
 
+TabWidgetPlus::TabId FormTabTester::selectedTabId() const
+{
+    auto selectedItem = ui->listWidget->currentItem();
+    if (nullptr == selectedItem) {
+        return 0;
+    }
+    return selectedItem->data(Qt::UserRole).toULongLong();
+}
+
 void FormTabTester::deleteTab()
 {
-    // Get the tab name (also the key) from the list widget and
-    // then delete the entry from the list widget.
+    // Get the tab ID from the list widget and then delete the entry
+    // from the list widget.
     auto selectedItem = ui->listWidget->currentItem();
     if (nullptr == selectedItem) {
         // Nothing currently selected.
         return;
     }
-    auto key = selectedItem->text().toStdString();
+    auto id = selectedTabId();
     delete ui->listWidget->takeItem(ui->listWidget->row(selectedItem));
 
-    if (0 == tabInfo.count(key)) {
-        // Invalid tab name.  (should never happen)
+    auto widget = getTabWidget()->widgetForId(id);
+    if (nullptr == widget) {
+        // The tab is already gone.  (should never happen)
         assert(false);
         return;
     }
-    tabInfo[key]->deleteLater();
-    tabInfo.erase(key);
+    widget->deleteLater();
 }
 
-void FormTabTester::tabSelected(const QString &currentText)
+void FormTabTester::tabSelected(const QString &)
 {
-    auto key = currentText.toStdString();
-    QWidget *widget = nullptr;
     auto tabWidget = getTabWidget();
+    auto id = selectedTabId();
+    auto isValid = true;
 
-    auto isValid = (0 != tabInfo.count(key));
-    if (isValid) {
-        widget = tabInfo[key];
-        auto tabState = tabWidget->tabState(widget);
-        switch (tabState) {
-        case TabWidgetPlus::tabWidgetState::hidden:
-            ui->isVisible->setChecked(false);
-            break;
-        case TabWidgetPlus::tabWidgetState::unknown:
-            isValid = false;
-            break;
-        case TabWidgetPlus::tabWidgetState::visible:
-            ui->isVisible->setChecked(true);
-            break;
-        }
+    switch (tabWidget->tabStateById(id)) {
+    case TabWidgetPlus::tabWidgetState::hidden:
+        ui->isVisible->setChecked(false);
+        break;
+    case TabWidgetPlus::tabWidgetState::unknown:
+        isValid = false;
+        break;
+    case TabWidgetPlus::tabWidgetState::visible:
+    case TabWidgetPlus::tabWidgetState::unmaterialized:
+        ui->isVisible->setChecked(true);
+        break;
     }
 
     ui->isVisible->setEnabled(isValid);
@@ -109,7 +116,7 @@ void FormTabTester::tabSelected(const QString &currentText)
 
     if (isValid) {
         // ui->isVisible already set in the case statement above.
-        ui->isEnabled->setChecked(widget->isEnabled());
+        ui->isEnabled->setChecked(tabWidget->widgetForId(id)->isEnabled());
     } else {
         ui->isVisible->setCheckState(Qt::CheckState::Unchecked);
         ui->isEnabled->setCheckState(Qt::CheckState::Unchecked);
@@ -118,16 +125,11 @@ void FormTabTester::tabSelected(const QString &currentText)
 
 void FormTabTester::enabledStateChanged(int state)
 {
-    auto selectedItem = ui->listWidget->currentItem();
-    if (nullptr == selectedItem) {
-        return;
-    }
-    auto key = selectedItem->text().toStdString();
-    if (0 == tabInfo.count(key)) {
+    auto widget = getTabWidget()->widgetForId(selectedTabId());
+    if (nullptr == widget) {
         // Nothing currently selected.
         return;
     }
-    auto widget = tabInfo[key];
 
     switch (static_cast<Qt::CheckState>(state)) {
     case Qt::CheckState::Unchecked:
@@ -144,24 +146,19 @@ void FormTabTester::enabledStateChanged(int state)
 
 void FormTabTester::visibleStateChanged(int state)
 {
-    auto selectedItem = ui->listWidget->currentItem();
-    if (nullptr == selectedItem) {
-        return;
-    }
-    auto key = selectedItem->text().toStdString();
-    if (0 == tabInfo.count(key)) {
+    auto id = selectedTabId();
+    auto tabWidget = getTabWidget();
+    if (nullptr == tabWidget->widgetForId(id)) {
         // Nothing currently selected.
         return;
     }
-    auto widget = tabInfo[key];
-    auto tabWidget = getTabWidget();
 
     switch (static_cast<Qt::CheckState>(state)) {
     case Qt::CheckState::Unchecked:
-        tabWidget->hideTab(widget);
+        tabWidget->hideTabById(id);
         break;
     case Qt::CheckState::Checked:
-        tabWidget->showTab(widget);
+        tabWidget->showTabById(id);
         break;
     case Qt::CheckState::PartiallyChecked:
         break;
@@ -171,88 +168,41 @@ void FormTabTester::visibleStateChanged(int state)
 
 void FormTabTester::barrage()
 {
-    qsrand(qrand());
-    if (nullptr != barrageTimer) {
-        barrageTimer->deleteLater();
-        barrageTimer = nullptr;
-    } else {
+    if (nullptr != barrageTimer && barrageTimer->isActive()) {
+        stopBarrage();
+        QMessageBox::information(this, "Barrage",
+                                 QString::number(barrageSteps) + " steps passed");
+        return;
+    }
+    if (nullptr == barrageTimer) {
         barrageTimer = new QTimer(this);
-        connect(barrageTimer, &QTimer::timeout, this, &FormTabTester::barrageTimeout);
-        barrageTimer->start(50);
+        connect(barrageTimer, &QTimer::timeout, this,
+                &FormTabTester::barrageChunk);
     }
+    barrageSteps = 0;
+    ui->btnBarrage->setText("Stop &Barrage");
+    barrageTimer->start(0);
 }
 
-void FormTabTester::barrageTimeout()
+void FormTabTester::barrageChunk()
 {
-    auto tabWidget = getTabWidget();
-
-    // Check: make sure any visible tabs are in the correct order.
-    auto tabNumber = -1;
-    auto visibleTabs = tabWidget->count();
-    for (auto i = 1; i < visibleTabs; ++i) {
-        auto temp = tabWidget->tabText(i).mid(4).toInt();
-        assert(temp > tabNumber);
-        tabNumber = temp;
-    }
-
-    enum class Actions { CreateTab, DeleteTab, ShowTab, HideTab };
-    auto action = Actions::CreateTab;
-    auto totalItems = ui->listWidget->count();
-
-    if (0 == totalItems) {
-        action = Actions::CreateTab;
-    } else if (20 < totalItems) {
-        action = Actions::DeleteTab;
-    } else {
-        switch (qrand() % 6) {
-        case 0:
-        case 1:
-            action = Actions::HideTab;
-            break;
-        case 2:
-        case 3:
-            action = Actions::ShowTab;
-            break;
-        case 4:
-            action = Actions::CreateTab;
-            break;
-        case 5:
-            action = Actions::DeleteTab;
-            break;
-        }
-    }
-
-    QWidget *widget = nullptr;
-    auto index = 0;
-    if (action != Actions::CreateTab) {
-        // Validate that we have a tab and set widget and index.
-        // If we fail for some reasons, change the action to make
-        // a new tab.
-        index = qrand() % totalItems;
-        auto item = ui->listWidget->item(index);
-        auto key = item->text().toStdString();
-        if (0 != tabInfo.count(key)) {
-            widget = tabInfo[key];
-        }
-        if (nullptr == widget) {
-            assert(false);
-            action = Actions::CreateTab;
-        }
+    // Small enough to keep each timer turn to a few milliseconds.
+    const quint64 chunkSteps = 2000;
+    auto seed = nextBarrageSeed++;
+    TabStressDriver driver;
+    auto result = driver.run(seed, chunkSteps);
+    barrageSteps += result.steps;
+    if (!result.failure.isEmpty()) {
+        stopBarrage();
+        QMessageBox::warning(this, "Barrage",
+                             "Seed " + QString::number(seed) + ", "
+                             + QString::number(chunkSteps) + " steps: "
+                             + TabStressDriver::report(result));
     }
+}
 
-    switch (action) {
-    case Actions::HideTab:
-        tabWidget->hideTab(widget);
-        break;
-    case Actions::ShowTab:
-        tabWidget->showTab(widget);
-        break;
-    case Actions::DeleteTab:
-        ui->listWidget->setCurrentRow(index);
-        deleteTab();
-        break;
-    case Actions::CreateTab:
-        createTab();
-        break;
-    }
+void FormTabTester::stopBarrage()
+{
+    barrageTimer->stop();
+    ui->btnBarrage->setText("&Barrage");
 }
@@ -1,17 +1,15 @@
 #ifndef FORMTABTESTER_H
 #define FORMTABTESTER_H
 
+#include "tabwidgetplus.h"
 #include <QWidget>
-#include <string>
-#include <unordered_map>
+
+class QTimer;
 
 namespace Ui {
 class FormTabTester;
 }
 
-class TabWidgetPlus;
-class QTimer;
-
 class FormTabTester : public QWidget
 {
     Q_OBJECT
@@ -22,13 +20,18 @@ public:
 
 private slots:
     /**
-     * @brief Create constant stream of create/delete/show/hide tab requests.
+     * @brief Start or stop random create/delete/show/hide tab requests.
      *
      * Use this function to simulate random (and frequently nonsensical)
-     * requests to the TabWidgetPlus. It can find edge cases in testing
-     * that might not be obvious to the developer.
+     * requests to a TabWidgetPlus. It can find edge cases in testing
+     * that might not be obvious to the developer.  The requests go to a
+     * private, headless tab widget (see TabStressDriver).  They run in
+     * short seeded chunks from a timer, so the demo stays responsive,
+     * until pressed again or a chunk fails; the report names the seed,
+     * so a failure can be reproduced with --stress.
      */
     void barrage();
+    void barrageChunk();
 
     void createTab();
     void deleteTab();
@@ -39,24 +42,28 @@ private slots:
      * When a tab name is select in the demo tab's list box, update the other
      * fields on the demo tab to reflect the tab' current state.
      *
-     * @param currentText The name of the tab used to update contents.
+     * @param currentText The name of the tab (the tab's ID is kept in
+     *                    the list item's data).
      */
     void tabSelected(const QString &currentText);
 
     void enabledStateChanged(int state);
     void visibleStateChanged(int state);
-    void barrageTimeout();
 
 private:
     Ui::FormTabTester *ui = nullptr;
     int nextTabNumber = 0;
     TabWidgetPlus *cachedTabWidget = nullptr;
+    quint32 nextBarrageSeed = 1;
     QTimer *barrageTimer = nullptr;
+    quint64 barrageSteps = 0;
 
-    typedef std::unordered_map<std::string, QWidget *> MapType;
-    MapType tabInfo;
+    void stopBarrage();
 
     TabWidgetPlus *getTabWidget();
+
+    // ID of the tab selected in the list box, or 0 if none is.
+    TabWidgetPlus::TabId selectedTabId() const;
 };
 
 #endif // FORMTABTESTER_H
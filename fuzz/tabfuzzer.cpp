@@ -0,0 +1,45 @@
+#include "tabstressdriver.h"
+#include <QApplication>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+//
+// libFuzzer entry points.  Each input is decoded into tab requests by
+// TabStressDriver::decode() (three bytes per request; up to two
+// trailing bytes are ignored) and run against the driver's reference
+// model; any disagreement aborts with the failing trace, in the text
+// form that "TabWidgetPlusDemo --replay <file>" reads back.
+//
+// See tabwidgetplusfuzz.pro for how to build and run it.
+//
+
+namespace {
+
+TabStressDriver *driver = nullptr;
+
+} // namespace
+
+extern "C" int LLVMFuzzerInitialize(int *, char ***)
+{
+    // Headless, and the application lives as long as the process.
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    static int argc = 1;
+    static char name[] = "tabfuzzer";
+    static char *argv[] = {name, nullptr};
+    new QApplication(argc, argv);
+
+    // A few tabs are enough to reach every case, and keep each
+    // check short.
+    driver = new TabStressDriver(8);
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    auto result = driver->replayReusing(TabStressDriver::decode(data, size));
+    if (!result.failure.isEmpty()) {
+        qFatal("%s", qPrintable(TabStressDriver::report(result)));
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#-------------------------------------------------
+#
+# libFuzzer harness for TabWidgetPlus (see tabfuzzer.cpp).  Needs clang:
+#
+#   qmake -spec linux-clang && make
+#   ./tabfuzzer -max_len=768 corpus/
+#
+# Copy corpus/ first if new inputs shouldn't be added to the seeds.
+# libFuzzer's status lines report the executions per second; there is
+# no target figure for it, and nothing here checks one.
+# It runs headless (offscreen platform) and must not be built with
+# NDEBUG, or TabWidgetPlus::checkConsistency() checks nothing.
+#
+#-------------------------------------------------
+
+QT       += core gui widgets concurrent
+CONFIG   += c++11 console
+CONFIG   -= app_bundle
+
+TARGET = tabfuzzer
+TEMPLATE = app
+INCLUDEPATH += ..
+
+QMAKE_CXXFLAGS += -g -fsanitize=fuzzer,address,undefined
+QMAKE_LFLAGS += -fsanitize=fuzzer,address,undefined
+
+SOURCES += tabfuzzer.cpp \
+    ../tabstressdriver.cpp \
+    ../tabwidgetplus.cpp \
+    ../tabregistry.cpp \
+    ../lazytabpage.cpp \
+    ../virtualtabbar.cpp \
+    ../tabsearchpopup.cpp \
+    ../tabwidgetstats.cpp \
+    ../tabpreviewcache.cpp \
+    ../tabcommandqueue.cpp \
+    ../tabactivationtracer.cpp \
+    ../tabgroup.cpp \
+    ../tabmemoryreport.cpp \
+    ../tabtimerthrottle.cpp
+
+HEADERS += ../tabstressdriver.h \
+    ../tabwidgetplus.h \
+    ../tabregistry.h \
+    ../lazytabpage.h \
+    ../virtualtabbar.h \
+    ../tabsearchpopup.h \
+    ../tabwidgetstats.h \
+    ../tabpreviewcache.h \
+    ../tabcommandqueue.h \
+    ../tabactivationtracer.h \
+    ../tabgroup.h \
+    ../tabmemoryreport.h \
+    ../tabtimerthrottle.h
@@ -0,0 +1,143 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#include "lazytabpage.h"
+#include <QFutureWatcher>
+#include <QProgressBar>
+#include <QVBoxLayout>
+#include <QtConcurrent>
+
+LazyTabPage::LazyTabPage(Factory factory, QWidget *parent)
+    : QWidget(parent), factory(std::move(factory))
+{
+}
+
+LazyTabPage::LazyTabPage(Preparer prepare, Builder build, QWidget *parent)
+    : QWidget(parent), dataReady(false)
+{
+    factory = [this, build]() {
+        return build(preparedData);
+    };
+
+    // A busy indicator (no range) until the data arrives.
+    auto pageLayout = new QVBoxLayout(this);
+    pageLayout->setContentsMargins(0, 0, 0, 0);
+    auto bar = new QProgressBar(this);
+    bar->setRange(0, 0);
+    bar->setTextVisible(false);
+    bar->setMaximumWidth(240);
+    pageLayout->addWidget(bar, 0, Qt::AlignCenter);
+    progress = bar;
+
+    //
+    // The watcher is our child, so if the page goes away first the
+    // result is simply dropped when the task finishes.
+    //
+    auto watcher = new QFutureWatcher<QVariant>(this);
+    connect(watcher, &QFutureWatcher<QVariant>::finished, this, [ = ]() {
+        preparedData = watcher->result();
+        dataReady = true;
+        watcher->deleteLater();
+        emit ready();
+    });
+    watcher->setFuture(QtConcurrent::run(prepare));
+}
+
+bool LazyTabPage::isMaterialized() const
+{
+    return !realPage.isNull();
+}
+
+bool LazyTabPage::isReady() const
+{
+    return dataReady;
+}
+
+QWidget *LazyTabPage::page() const
+{
+    return realPage.data();
+}
+
+quint64 LazyTabPage::lastActivated() const
+{
+    return activationStamp;
+}
+
+void LazyTabPage::setLastActivated(quint64 stamp)
+{
+    activationStamp = stamp;
+}
+
+void LazyTabPage::materialize()
+{
+    if (isMaterialized() || !factory || !dataReady) {
+        return;
+    }
+    auto newPage = factory();
+    if (nullptr == newPage) {
+        return;
+    }
+    realPage = newPage;
+    delete progress.data();
+
+    // The layout is only created now, so a page that is never opened
+    // costs no more than a bare QWidget.
+    auto pageLayout = layout();
+    if (nullptr == pageLayout) {
+        pageLayout = new QVBoxLayout(this);
+        pageLayout->setContentsMargins(0, 0, 0, 0);
+    }
+    pageLayout->addWidget(newPage);
+
+    // Coming back after an eviction:  hand the page its old state.
+    if (!savedState.isEmpty()) {
+        auto state = dynamic_cast<TabPageState *>(newPage);
+        if (nullptr != state) {
+            state->restoreTabState(savedState);
+        }
+        savedState.clear();
+    }
+
+    // The tab text follows this widget's window title, so pass the
+    // page's title along whenever it has one.
+    if (!newPage->windowTitle().isEmpty()) {
+        setWindowTitle(newPage->windowTitle());
+    }
+    connect(newPage, &QWidget::windowTitleChanged,
+            this, &QWidget::setWindowTitle);
+
+    emit materialized(newPage);
+}
+
+void LazyTabPage::evict()
+{
+    if (!isMaterialized()) {
+        return;
+    }
+    auto state = dynamic_cast<TabPageState *>(realPage.data());
+    if (nullptr != state) {
+        savedState = state->saveTabState();
+    }
+    delete realPage.data();
+    emit evicted();
+}
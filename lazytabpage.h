@@ -0,0 +1,120 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#ifndef LAZYTABPAGE_H
+#define LAZYTABPAGE_H
+
+#include <QByteArray>
+#include <QPointer>
+#include <QVariant>
+#include <QWidget>
+#include <functional>
+
+/**
+ * @brief Optional interface for pages that can be evicted and rebuilt.
+ *
+ * A page built by a LazyTabPage may also inherit from this class.  When
+ * the page is evicted its state is saved first, and handed back to the
+ * freshly built page when the tab is next opened.  Pages that don't
+ * implement it are simply rebuilt from scratch.
+ */
+class TabPageState
+{
+public:
+    virtual ~TabPageState() = default;
+    virtual QByteArray saveTabState() const = 0;
+    virtual void restoreTabState(const QByteArray &state) = 0;
+};
+
+/**
+ * @brief Lightweight stand-in for a tab page that is built on demand.
+ *
+ * TabWidgetPlus puts one of these in the tab bar in place of the real
+ * page.  It stays the tab's widget for the life of the tab, so it can be
+ * passed to hideTab(), showTab() and tabState() like any other page; the
+ * real page is created from the factory and placed inside it the first
+ * time the tab becomes current.
+ *
+ * The real page can later be evicted (destroyed) to save memory and is
+ * rebuilt, with its saved TabPageState if it has one, on next use.
+ *
+ * An asynchronous page splits the work in two:  'prepare' runs on the
+ * global thread pool as soon as the page is created, to load whatever
+ * data the page needs, and 'build' turns that data into widgets on the
+ * GUI thread.  Until the data is ready the page shows a busy progress
+ * bar and materialize() does nothing.  The data is kept, so an evicted
+ * page is rebuilt without preparing it again.
+ */
+class LazyTabPage : public QWidget
+{
+    Q_OBJECT
+public:
+    typedef std::function<QWidget *()> Factory;
+
+    // 'prepare' must not touch any widget:  it runs on another thread.
+    typedef std::function<QVariant()> Preparer;
+    typedef std::function<QWidget *(const QVariant &data)> Builder;
+
+    explicit LazyTabPage(Factory factory, QWidget *parent = 0);
+    LazyTabPage(Preparer prepare, Builder build, QWidget *parent = 0);
+    virtual ~LazyTabPage() = default;
+
+    bool isMaterialized() const;
+
+    // False while an asynchronous page's data is still being prepared.
+    bool isReady() const;
+
+    // The real page, or nullptr if it hasn't been built yet.
+    QWidget *page() const;
+
+    // Ordering stamp for least-recently-used eviction; larger is newer.
+    // TabWidgetPlus sets it when the page is activated or built.
+    quint64 lastActivated() const;
+    void setLastActivated(quint64 stamp);
+
+signals:
+    void materialized(QWidget *page);
+    void evicted();
+
+    // An asynchronous page's data is ready, so materialize() can build it.
+    void ready();
+
+public slots:
+    // Build the real page now if it hasn't been built already.
+    void materialize();
+
+    // Save the real page's state (if it supports TabPageState) and
+    // destroy it.  Does nothing if the page isn't built.
+    void evict();
+
+private:
+    Factory factory;
+    QPointer<QWidget> realPage;
+    QVariant preparedData;
+    bool dataReady = true;
+    QPointer<QWidget> progress;
+    QByteArray savedState;
+    quint64 activationStamp = 0;
+};
+
+#endif // LAZYTABPAGE_H
@@ -1,9 +1,45 @@
 #include "mainwindow.h"
+#include "tabstressdriver.h"
 #include <QApplication>
+#include <QFile>
+#include <QTextStream>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    // "--stress [steps] [seed]" runs the fixed scenarios and then the
+    // seeded stress driver, and "--replay <file>" reruns a trace it
+    // printed.  Both exit non-zero if the tab widget went wrong.  The
+    // benchmarks are in bench/.
+    auto arguments = a.arguments();
+    auto stress = arguments.indexOf("--stress");
+    if (-1 != stress) {
+        auto steps = arguments.value(stress + 1, "1000000").toULongLong();
+        auto seed = arguments.value(stress + 2, "1").toUInt();
+        auto failures = TabStressDriver::scenarios();
+        for (const auto &failure : failures) {
+            QTextStream(stdout) << "scenario " << failure << "\n";
+        }
+        auto result = TabStressDriver().run(seed, steps);
+        QTextStream(stdout) << "seed " << seed << ": "
+                            << TabStressDriver::report(result);
+        return result.failure.isEmpty() && failures.isEmpty() ? 0 : 1;
+    }
+    auto replay = arguments.indexOf("--replay");
+    if (-1 != replay) {
+        QFile file(arguments.value(replay + 1));
+        auto ok = file.open(QIODevice::ReadOnly | QIODevice::Text);
+        auto trace = TabStressDriver::parse(QString::fromUtf8(file.readAll()), &ok);
+        if (!ok) {
+            QTextStream(stderr) << "cannot read trace " << file.fileName() << "\n";
+            return 2;
+        }
+        auto result = TabStressDriver().replay(trace);
+        QTextStream(stdout) << TabStressDriver::report(result);
+        return result.failure.isEmpty() ? 0 : 1;
+    }
+
     MainWindow w;
     w.show();
 
@@ -1,4 +1,5 @@
 #include "mainwindow.h"
+#include "tabwidgetplus.h"
 #include "ui_mainwindow.h"
 
 MainWindow::MainWindow(QWidget *parent) :
@@ -6,6 +7,23 @@ MainWindow::MainWindow(QWidget *parent) :
     ui(new Ui::MainWindow)
 {
     ui->setupUi(this);
+    ui->tabWidget->setMovable(true);
+
+    // Live view of the tab widget's counters, once a second.
+    connect(ui->tabWidget, &TabWidgetPlus::statsUpdated, this,
+    [ = ](const TabWidgetStats & stats) {
+        auto message = QString::number(stats.tabCount) + " tabs ("
+                       + QString::number(stats.hiddenTabCount) + " hidden)";
+        if (stats.enabled) {
+            const auto &hide = stats.probes[TabWidgetStats::HideTab];
+            const auto &show = stats.probes[TabWidgetStats::ShowTab];
+            message += ", slowest hide/show " + QString::number(hide.maxNsecs / 1000) + "/"
+                       + QString::number(show.maxNsecs / 1000) + " us, "
+                       + QString::number(stats.relayouts) + " relayouts";
+        }
+        ui->statusBar->showMessage(message);
+    });
+    ui->tabWidget->setStatsInterval(1000);
 }
 
 MainWindow::~MainWindow()
@@ -0,0 +1,265 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#include "tabactivationtracer.h"
+#include "lazytabpage.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QSaveFile>
+#include <QWidget>
+#include <algorithm>
+#include <chrono>
+
+TabActivationTracer::TabActivationTracer(QObject *parent) : QObject(parent)
+{
+}
+
+qint64 TabActivationTracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QString TabActivationTracer::pageType(QWidget *page)
+{
+    if (nullptr == page) {
+        return QString();
+    }
+    auto lazyPage = qobject_cast<LazyTabPage *>(page);
+    if (nullptr != lazyPage && nullptr != lazyPage->page()) {
+        page = lazyPage->page();
+    }
+    return QString::fromLatin1(page->metaObject()->className());
+}
+
+void TabActivationTracer::beginActivation(QWidget *page)
+{
+    if (activationPending) {
+        ++abandonedCount;
+    }
+    activation.page = page;
+    activation.span = Span();
+    activation.span.name = QStringLiteral("activate");
+    activation.span.start = now();
+    activationPending = nullptr != page;
+}
+
+void TabActivationTracer::activationBookkeepingDone()
+{
+    if (activationPending) {
+        activation.span.bookkeepingEnd = now();
+        activation.span.pageType = pageType(activation.page);
+    }
+}
+
+void TabActivationTracer::pagePainted(QWidget *page)
+{
+    if (!activationPending || activation.page != page) {
+        return;
+    }
+    activation.span.end = now();
+    if (0 == activation.span.bookkeepingEnd) {
+        activation.span.bookkeepingEnd = activation.span.end;
+        activation.span.pageType = pageType(page);
+    }
+    activationPending = false;
+    record(activation.span);
+}
+
+void TabActivationTracer::beginShow(QWidget *page)
+{
+    //
+    // A show whose tab bar never paints (window minimized, updates
+    // off) would wait forever, so shows are given up on after a while,
+    // and past a fixed number, oldest first.  They start in order, so
+    // the ones to drop are always at the front.
+    //
+    auto startedAt = now();
+    auto stale = std::find_if(shows.begin(), shows.end(), [startedAt](const Pending & show) {
+        return startedAt - show.span.start < maxShowWait;
+    }) - shows.begin();
+    auto excess = static_cast<std::ptrdiff_t>(shows.size()) + 1 - maxPendingShows;
+    auto dropped = std::max<std::ptrdiff_t>(stale, excess);
+    if (0 < dropped) {
+        shows.erase(shows.begin(), shows.begin() + dropped);
+        abandonedCount += static_cast<quint64>(dropped);
+    }
+
+    Pending show;
+    show.page = page;
+    show.span.name = QStringLiteral("showTab");
+    show.span.pageType = pageType(page);
+    show.span.start = startedAt;
+    shows.push_back(show);
+}
+
+void TabActivationTracer::showDone(bool waitForPaint)
+{
+    if (shows.empty()) {
+        return;
+    }
+    auto &show = shows.back();
+    show.span.bookkeepingEnd = now();
+    if (!waitForPaint) {
+        show.span.end = show.span.bookkeepingEnd;
+        record(show.span);
+        shows.pop_back();
+    }
+}
+
+void TabActivationTracer::tabBarPainted()
+{
+    // A batch of shows all reach the screen with the same paint.
+    auto paintedAt = now();
+    for (auto &show : shows) {
+        if (0 != show.span.bookkeepingEnd) {
+            show.span.end = paintedAt;
+            record(show.span);
+        }
+    }
+    shows.erase(std::remove_if(shows.begin(), shows.end(), [](const Pending & show) {
+        return 0 != show.span.end;
+    }), shows.end());
+}
+
+void TabActivationTracer::record(const Span &span)
+{
+    finished.push_back(span);
+    while (static_cast<int>(finished.size()) > spanLimit) {
+        finished.pop_front();
+    }
+}
+
+const std::deque<TabActivationTracer::Span> &TabActivationTracer::spans() const
+{
+    return finished;
+}
+
+void TabActivationTracer::clear()
+{
+    finished.clear();
+    abandonedCount = 0;
+}
+
+void TabActivationTracer::setMaxSpans(int spans)
+{
+    spanLimit = std::max(spans, 1);
+    while (static_cast<int>(finished.size()) > spanLimit) {
+        finished.pop_front();
+    }
+}
+
+int TabActivationTracer::maxSpans() const
+{
+    return spanLimit;
+}
+
+void TabActivationTracer::setFrameBudget(qint64 nsecs)
+{
+    budget = nsecs;
+}
+
+qint64 TabActivationTracer::frameBudget() const
+{
+    return budget;
+}
+
+quint64 TabActivationTracer::abandoned() const
+{
+    return abandonedCount;
+}
+
+QString TabActivationTracer::report() const
+{
+    QMap<QString, std::vector<qint64>> durations;
+    for (const auto &span : finished) {
+        durations[span.name + "\t" + span.pageType].push_back(span.end - span.start);
+    }
+
+    QString result = "span\tpage\tcount\tp50(ms)\tp95(ms)\tp99(ms)\tover budget\n";
+    for (auto iter = durations.begin(); iter != durations.end(); ++iter) {
+        auto &samples = iter.value();
+        std::sort(samples.begin(), samples.end());
+        auto percentile = [&samples](double fraction) {
+            auto index = static_cast<std::size_t>(fraction * (samples.size() - 1));
+            return QString::number(samples[index] / 1e6, 'f', 2);
+        };
+        auto overBudget = samples.end()
+                          - std::upper_bound(samples.begin(), samples.end(), budget);
+        result += iter.key() + "\t" + QString::number(static_cast<int>(samples.size())) + "\t"
+                  + percentile(0.50) + "\t" + percentile(0.95) + "\t"
+                  + percentile(0.99) + "\t" + QString::number(static_cast<int>(overBudget)) + "\n";
+    }
+    if (0 != abandonedCount) {
+        result += QString::number(abandonedCount) + " activations or shows never painted\n";
+    }
+    return result;
+}
+
+QByteArray TabActivationTracer::chromeTrace() const
+{
+    //
+    // Complete ("X") events, in microseconds.  Each span gets its
+    // bookkeeping part as a nested event on the same track.
+    //
+    QJsonArray events;
+    auto addEvent = [&events](const QString & name, const QString & category,
+                              const QString & page, qint64 start, qint64 end) {
+        QJsonObject args;
+        args.insert("page", page);
+        QJsonObject event;
+        event.insert("name", name);
+        event.insert("cat", category);
+        event.insert("ph", "X");
+        event.insert("ts", start / 1000.0);
+        event.insert("dur", (end - start) / 1000.0);
+        event.insert("pid", 1);
+        event.insert("tid", 1);
+        event.insert("args", args);
+        events.append(event);
+    };
+    for (const auto &span : finished) {
+        addEvent(span.name + " " + span.pageType, span.name, span.pageType,
+                 span.start, span.end);
+        if (0 != span.bookkeepingEnd) {
+            addEvent("bookkeeping", span.name, span.pageType,
+                     span.start, span.bookkeepingEnd);
+        }
+    }
+    QJsonObject trace;
+    trace.insert("traceEvents", events);
+    trace.insert("displayTimeUnit", "ms");
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+bool TabActivationTracer::saveChromeTrace(const QString &fileName) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(chromeTrace());
+    return file.commit();
+}
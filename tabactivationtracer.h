@@ -0,0 +1,117 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#ifndef TABACTIVATIONTRACER_H
+#define TABACTIVATIONTRACER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <deque>
+#include <vector>
+
+class QWidget;
+
+/**
+ * @brief Times how long tab switches and showTab() take to reach the
+ * screen.
+ *
+ * TabWidgetPlus feeds this from its own hooks (see
+ * TabWidgetPlus::setActivationTracing()):
+ *
+ * - "activate" runs from currentChanged() to the first paint event the
+ *   new page receives, with the tab widget's own work (including
+ *   building a lazy page) marked as the "bookkeeping" part of it.
+ * - "showTab" runs from the showTab() call to the next paint of the
+ *   tab bar, or to the end of the call if the tab bar isn't shown.
+ *
+ * Spans are grouped by page type (the page's class name; the built
+ * page for a LazyTabPage).  The most recent maxSpans() are kept.
+ */
+class TabActivationTracer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TabActivationTracer(QObject *parent = nullptr);
+
+    struct Span {
+        QString name;
+        QString pageType;
+        qint64 start = 0;           // steady clock, ns
+        qint64 bookkeepingEnd = 0;  // 0 if there is no such part
+        qint64 end = 0;
+    };
+
+    // Hooks, called by TabWidgetPlus.
+    void beginActivation(QWidget *page);
+    void activationBookkeepingDone();
+    void pagePainted(QWidget *page);
+    void beginShow(QWidget *page);
+    void showDone(bool waitForPaint);
+    void tabBarPainted();
+
+    const std::deque<Span> &spans() const;
+    void clear();
+    void setMaxSpans(int spans);
+    int maxSpans() const;
+
+    // Spans longer than this count as over budget in report().
+    void setFrameBudget(qint64 nsecs);
+    qint64 frameBudget() const;
+
+    // Activations replaced by another before their page painted, and
+    // shows given up on before the tab bar painted.
+    quint64 abandoned() const;
+
+    // p50/p95/p99 and over-budget counts per span name and page type.
+    QString report() const;
+
+    // Chrome trace-event JSON, for chrome://tracing or Perfetto.
+    QByteArray chromeTrace() const;
+    bool saveChromeTrace(const QString &fileName) const;
+
+private:
+    static qint64 now();
+    static QString pageType(QWidget *page);
+    void record(const Span &span);
+
+    struct Pending {
+        QPointer<QWidget> page;
+        Span span;
+    };
+    Pending activation;
+    bool activationPending = false;
+    std::vector<Pending> shows;
+
+    // Limits on 'shows' (see beginShow()).
+    enum { maxPendingShows = 1024 };
+    static const qint64 maxShowWait = 10000000000ll; // 10 s
+
+    std::deque<Span> finished;
+    int spanLimit = 100000;
+    qint64 budget = 16666667; // one 60 Hz frame
+    quint64 abandonedCount = 0;
+};
+
+#endif // TABACTIVATIONTRACER_H
@@ -0,0 +1,300 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#include "tabcommandqueue.h"
+#include "tabwidgetplus.h"
+#include <QMetaObject>
+#include <QWidget>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+qint64 steadyNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+TabCommandQueue::TabCommandQueue(TabWidgetPlus *tabWidget)
+    : QObject(tabWidget), tabWidget(tabWidget), head(&stub), tail(&stub),
+      drainScheduled(false), postedCount(0)
+{
+    stub.next.store(nullptr, std::memory_order_relaxed);
+    connect(tabWidget, &TabWidgetPlus::tabReleased, this, [ = ](QWidget * widget) {
+        auto iter = keys.find(widget->objectName());
+        if (iter != keys.end() && iter->data() == widget) {
+            keys.erase(iter);
+        }
+    });
+}
+
+TabCommandQueue::~TabCommandQueue()
+{
+    for (auto node = pop(); nullptr != node; node = pop()) {
+        delete node;
+    }
+}
+
+void TabCommandQueue::postCreate(const QString &key, const QString &title,
+                                 Factory factory)
+{
+    post(Command::Create, key, title, std::move(factory));
+}
+
+void TabCommandQueue::postHide(const QString &key)
+{
+    post(Command::Hide, key, QString(), Factory());
+}
+
+void TabCommandQueue::postShow(const QString &key)
+{
+    post(Command::Show, key, QString(), Factory());
+}
+
+void TabCommandQueue::postRetitle(const QString &key, const QString &title)
+{
+    post(Command::Retitle, key, title, Factory());
+}
+
+void TabCommandQueue::postSetEnabled(const QString &key, bool enabled)
+{
+    post(enabled ? Command::Enable : Command::Disable, key, QString(), Factory());
+}
+
+void TabCommandQueue::post(Command::Type type, const QString &key,
+                           const QString &title, Factory factory)
+{
+    auto node = new Node;
+    node->command.type = type;
+    node->command.key = key;
+    node->command.title = title;
+    node->command.factory = std::move(factory);
+    node->command.postedAt = steadyNow();
+    push(node);
+    postedCount.fetch_add(1, std::memory_order_relaxed);
+
+    // Only the post that finds no drain pending wakes the GUI thread.
+    if (!drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, "drain", Qt::QueuedConnection);
+    }
+}
+
+void TabCommandQueue::push(Node *node)
+{
+    node->next.store(nullptr, std::memory_order_relaxed);
+    auto previous = head.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_release);
+}
+
+TabCommandQueue::Node *TabCommandQueue::pop()
+{
+    auto first = tail;
+    auto next = first->next.load(std::memory_order_acquire);
+    if (&stub == first) {
+        if (nullptr == next) {
+            return nullptr;
+        }
+        tail = next;
+        first = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (nullptr != next) {
+        tail = next;
+        return first;
+    }
+    if (first != head.load(std::memory_order_acquire)) {
+        // A producer has swapped itself in but not linked up yet.  It
+        // will schedule another drain once it has.
+        return nullptr;
+    }
+    push(&stub);
+    next = first->next.load(std::memory_order_acquire);
+    if (nullptr != next) {
+        tail = next;
+        return first;
+    }
+    return nullptr;
+}
+
+void TabCommandQueue::bind(const QString &key, QWidget *widget)
+{
+    widget->setObjectName(key);
+    if (keys.value(key).data() == widget) {
+        return;
+    }
+    keys.insert(key, widget);
+
+    // Forget the key with the page, unless it was bound again since.
+    connect(widget, &QObject::destroyed, this, [ = ]() {
+        auto iter = keys.find(key);
+        if (iter != keys.end() && iter->isNull()) {
+            keys.erase(iter);
+        }
+    });
+}
+
+QWidget *TabCommandQueue::widgetForKey(const QString &key) const
+{
+    return keys.value(key).data();
+}
+
+void TabCommandQueue::setMaxBatch(int commands)
+{
+    batchLimit = std::max(commands, 1);
+}
+
+int TabCommandQueue::maxBatch() const
+{
+    return batchLimit;
+}
+
+TabCommandQueue::Stats TabCommandQueue::stats() const
+{
+    auto result = drainStats;
+    result.posted = postedCount.load(std::memory_order_relaxed);
+    return result;
+}
+
+void TabCommandQueue::drain()
+{
+    // Clearing the flag first means a post racing with this drain
+    // schedules the next one, so nothing is left behind.
+    drainScheduled.exchange(false, std::memory_order_acq_rel);
+
+    std::vector<Command> commands;
+    for (auto node = pop(); nullptr != node; node = pop()) {
+        commands.push_back(std::move(node->command));
+        delete node;
+        if (static_cast<int>(commands.size()) == batchLimit) {
+            // Leave the rest for the next turn, so input and painting
+            // get a look in.
+            if (!drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+                QMetaObject::invokeMethod(this, "drain", Qt::QueuedConnection);
+            }
+            break;
+        }
+    }
+    if (commands.empty()) {
+        return;
+    }
+
+    //
+    // Fold the commands for each key into its final state, keeping the
+    // keys in the order they first appear (so new tabs keep theirs).
+    //
+    struct Folded {
+        QString key;
+        bool create = false;
+        QString createTitle;
+        Factory factory;
+        int visible = -1;
+        int enabled = -1;
+        bool retitle = false;
+        QString title;
+    };
+    std::vector<Folded> folded;
+    QHash<QString, int> positions;
+    for (auto &command : commands) {
+        auto position = positions.value(command.key, -1);
+        if (-1 == position) {
+            position = static_cast<int>(folded.size());
+            positions.insert(command.key, position);
+            folded.push_back(Folded());
+            folded.back().key = command.key;
+        }
+        auto &state = folded[position];
+        switch (command.type) {
+        case Command::Create:
+            if (!state.create) {
+                state.create = true;
+                state.createTitle = command.title;
+                state.factory = std::move(command.factory);
+            }
+            break;
+        case Command::Hide:
+        case Command::Show:
+            state.visible = Command::Show == command.type ? 1 : 0;
+            break;
+        case Command::Enable:
+        case Command::Disable:
+            state.enabled = Command::Enable == command.type ? 1 : 0;
+            break;
+        case Command::Retitle:
+            state.retitle = true;
+            state.title = command.title;
+            break;
+        }
+    }
+
+    quint64 applied = 0;
+    {
+        TabWidgetPlus::BatchScope batch(tabWidget);
+        for (auto &state : folded) {
+            auto widget = keys.value(state.key).data();
+            applied += (state.create ? 1 : 0) + (-1 != state.visible ? 1 : 0)
+                       + (-1 != state.enabled ? 1 : 0) + (state.retitle ? 1 : 0);
+            if (nullptr == widget && state.create && state.factory) {
+                widget = state.factory();
+                if (nullptr == widget) {
+                    continue;
+                }
+                bind(state.key, widget);
+                if (-1 != state.enabled) {
+                    widget->setEnabled(1 == state.enabled);
+                }
+                auto title = state.retitle ? state.title : state.createTitle;
+                if (0 == state.visible) {
+                    tabWidget->addHiddenTab(widget, title);
+                } else {
+                    tabWidget->addTab(widget, title);
+                }
+                continue;
+            }
+            if (nullptr == widget) {
+                continue;
+            }
+            if (-1 != state.enabled) {
+                widget->setEnabled(1 == state.enabled);
+            }
+            if (state.retitle) {
+                widget->setWindowTitle(state.title);
+            }
+            if (0 == state.visible) {
+                tabWidget->hideTab(widget);
+            } else if (1 == state.visible) {
+                tabWidget->showTab(widget);
+            }
+        }
+    }
+
+    auto now = steadyNow();
+    for (const auto &command : commands) {
+        drainStats.latency.record(static_cast<quint64>(now - command.postedAt));
+    }
+    drainStats.drained += commands.size();
+    drainStats.coalesced += commands.size() - std::min<quint64>(applied, commands.size());
+}
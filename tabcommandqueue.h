@@ -0,0 +1,130 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#ifndef TABCOMMANDQUEUE_H
+#define TABCOMMANDQUEUE_H
+
+#include "tabwidgetstats.h"
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <atomic>
+#include <functional>
+
+class QWidget;
+class TabWidgetPlus;
+
+/**
+ * @brief Lets any thread ask a TabWidgetPlus to change its tabs.
+ *
+ * The post*() methods can be called from any thread.  They append to a
+ * lock-free multi-producer, single-consumer queue (an intrusive Vyukov
+ * queue:  one atomic exchange per post, no locks), and only the post
+ * that finds the queue idle wakes the GUI thread, so a burst of posts
+ * costs a single queued event.
+ *
+ * On the GUI thread drain() takes at most maxBatch() commands per event
+ * loop turn, folds the commands for each tab into its final state (a
+ * hide followed by a show is no change at all) and applies the result
+ * inside one BatchScope.
+ *
+ * Tabs are named by a key, which becomes the page's objectName().  Tabs
+ * made with postCreate() get their key automatically; bind() gives one
+ * to a page that was added some other way.  A key is forgotten when its
+ * page is deleted or leaves the tab widget, so commands for it after
+ * that do nothing (or, for postCreate(), make a new tab).
+ *
+ * The queue must outlive every thread that posts to it.
+ */
+class TabCommandQueue : public QObject
+{
+    Q_OBJECT
+public:
+    typedef std::function<QWidget *()> Factory;
+
+    explicit TabCommandQueue(TabWidgetPlus *tabWidget);
+    ~TabCommandQueue();
+
+    // Thread safe.  The factory runs on the GUI thread.
+    void postCreate(const QString &key, const QString &title, Factory factory);
+    void postHide(const QString &key);
+    void postShow(const QString &key);
+    void postRetitle(const QString &key, const QString &title);
+    void postSetEnabled(const QString &key, bool enabled);
+
+    // GUI thread only.
+    void bind(const QString &key, QWidget *widget);
+    QWidget *widgetForKey(const QString &key) const;
+    void setMaxBatch(int commands);
+    int maxBatch() const;
+
+    struct Stats {
+        quint64 posted = 0;
+        quint64 drained = 0;
+        // Drained commands that folded into another one.
+        quint64 coalesced = 0;
+        // Time from post to being applied.
+        TabWidgetStats::Histogram latency;
+    };
+    // Not a consistent snapshot while other threads are posting.
+    Stats stats() const;
+
+public slots:
+    void drain();
+
+private:
+    struct Command {
+        enum Type { Create, Hide, Show, Retitle, Enable, Disable };
+        Type type = Create;
+        QString key;
+        QString title;
+        Factory factory;
+        qint64 postedAt = 0;
+    };
+    struct Node {
+        std::atomic<Node *> next;
+        Command command;
+    };
+
+    void post(Command::Type type, const QString &key, const QString &title,
+              Factory factory);
+    void push(Node *node);
+    Node *pop();
+
+    TabWidgetPlus *tabWidget;
+
+    // Producers swap themselves in at 'head'; the GUI thread reads from
+    // 'tail'.  'stub' keeps the list from ever being empty.
+    std::atomic<Node *> head;
+    Node *tail;
+    Node stub;
+    std::atomic<bool> drainScheduled;
+    std::atomic<quint64> postedCount;
+
+    QHash<QString, QPointer<QWidget>> keys;
+    int batchLimit = 4096;
+    Stats drainStats;
+};
+
+#endif // TABCOMMANDQUEUE_H
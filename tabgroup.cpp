@@ -0,0 +1,183 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#include "tabgroup.h"
+#include "tabwidgetplus.h"
+#include <QEvent>
+#include <algorithm>
+
+TabGroup::TabGroup(QObject *parent) : QObject(parent)
+{
+}
+
+TabGroup::~TabGroup()
+{
+    // Views outlive the group happily:  they just take their hooks back.
+    while (!viewList.isEmpty()) {
+        removeView(viewList.first());
+    }
+}
+
+bool TabGroup::addView(TabWidgetPlus *view)
+{
+    if (nullptr != view->tabGroup) {
+        return this == view->tabGroup;
+    }
+    if (0 != view->registry.size()) {
+        return false;
+    }
+    // IDs the view gave out on its own stay retired.
+    lastId = std::max(lastId, view->registry.highestId());
+    view->tabGroup = this;
+    viewList.append(view);
+    return true;
+}
+
+void TabGroup::removeView(TabWidgetPlus *view)
+{
+    if (this != view->tabGroup) {
+        return;
+    }
+    //
+    // The view's tabs keep their entries (and so their IDs); only the
+    // hooks change hands.  Group IDs are never reused, and the view's
+    // registry only counts up from the largest ID it has seen, so the
+    // IDs it hands out later can't clash with these.
+    //
+    auto &registry = view->registry;
+    for (auto entry = registry.first(); nullptr != entry;
+            entry = registry.next(entry)) {
+        untrack(entry->widget, entry->widgetDestroyed);
+    }
+    view->tabGroup = nullptr;
+    for (auto entry = registry.first(); nullptr != entry;
+            entry = registry.next(entry)) {
+        if (!entry->widgetDestroyed) {
+            view->trackWidget(entry);
+        }
+    }
+    viewList.removeOne(view);
+}
+
+QList<TabWidgetPlus *> TabGroup::views() const
+{
+    return viewList;
+}
+
+TabWidgetPlus *TabGroup::viewOf(const QWidget *page) const
+{
+    auto iter = pages.find(page);
+    return iter == pages.end() ? nullptr : iter->view;
+}
+
+QWidget *TabGroup::widgetForId(quint64 id) const
+{
+    for (auto view : viewList) {
+        auto widget = view->widgetForId(id);
+        if (nullptr != widget) {
+            return widget;
+        }
+    }
+    return nullptr;
+}
+
+bool TabGroup::moveTab(QWidget *page, TabWidgetPlus *to, int index)
+{
+    auto iter = pages.find(page);
+    if (iter == pages.end() || this != to->tabGroup) {
+        return false;
+    }
+    //
+    // The page's hooks stay where they are; only the view they report
+    // to changes, and it changes before the new view touches the page
+    // (adoptTab() sets its window title, which the hooks forward).
+    //
+    auto from = iter->view;
+    TabWidgetPlus::MovedTab tab;
+    from->releaseTab(page, tab);
+    pages.find(page)->view = to;
+    to->adoptTab(page, tab, index);
+    emit tabMoved(page, from, to);
+    return true;
+}
+
+bool TabGroup::eventFilter(QObject *obj, QEvent *event)
+{
+    // Skip the lookup for the events no view would act on.
+    if (!TabWidgetPlus::isTrackedEvent(event->type())) {
+        return false;
+    }
+    // Pages are the only objects we filter, so the cast is safe.
+    auto view = viewOf(static_cast<QWidget *>(obj));
+    if (nullptr == view) {
+        return false;
+    }
+    return view->eventFilter(obj, event);
+}
+
+void TabGroup::track(QWidget *page, TabWidgetPlus *view)
+{
+    //
+    // The same hooks TabWidgetPlus::trackWidget() installs on its own,
+    // except that they look the owning view up each time, so a move is
+    // just a change to 'view'.
+    //
+    auto &record = pages[page];
+    record.view = view;
+    page->installEventFilter(this);
+    record.destroyedConnection = connect(page, &QObject::destroyed, this,
+    [ = ](QObject *) {
+        auto owner = viewOf(page);
+        if (nullptr != owner) {
+            owner->removeHiddenTabData(page);
+        }
+    });
+    record.titleConnection = connect(page, &QWidget::windowTitleChanged, this,
+    [ = ](const QString &) {
+        auto owner = viewOf(page);
+        if (nullptr != owner) {
+            owner->updateTabText(page);
+        }
+    });
+}
+
+void TabGroup::untrack(QWidget *page, bool destroyed)
+{
+    auto iter = pages.find(page);
+    if (iter == pages.end()) {
+        return;
+    }
+    // As in TabWidgetPlus::untrackWidget(), a destroyed page has no
+    // connections or event filter left to remove.
+    if (!destroyed) {
+        page->removeEventFilter(this);
+        disconnect(iter->destroyedConnection);
+        disconnect(iter->titleConnection);
+    }
+    pages.erase(iter);
+}
+
+quint64 TabGroup::nextId()
+{
+    return ++lastId;
+}
@@ -0,0 +1,114 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#ifndef TABGROUP_H
+#define TABGROUP_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+
+class QWidget;
+class TabWidgetPlus;
+
+/**
+ * @brief Several TabWidgetPlus views sharing one set of pages.
+ *
+ * A page belongs to exactly one view at a time, and that view's
+ * registry is the only place its position and hidden state are kept.
+ * What the group adds is everything that has to outlive a move:  the
+ * page's event filter and its destroyed()/windowTitleChanged() hooks
+ * are installed once, by the group, and are forwarded to whichever
+ * view holds the page.  Tab IDs are handed out by the group, so they
+ * are unique across every view and a page keeps its ID when it moves.
+ *
+ * moveTab() takes a page (hidden or not) out of one view and puts it
+ * into another without rebuilding it:  the widget is only reparented,
+ * so lazy pages stay built and pages keep whatever state they hold.
+ */
+class TabGroup : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TabGroup(QObject *parent = nullptr);
+    virtual ~TabGroup();
+
+    /**
+     * @brief Attach a view to the group.
+     *
+     * A view can only join while it has no tabs (hidden or not), since
+     * its tab IDs must come from the group, and it can be in at most
+     * one group.
+     *
+     * @return false if the view has tabs or is in another group.
+     */
+    bool addView(TabWidgetPlus *view);
+
+    // Detach a view.  Its tabs stay with it, keeping their IDs, and
+    // get their own hooks again.
+    void removeView(TabWidgetPlus *view);
+    QList<TabWidgetPlus *> views() const;
+
+    // The view a page is in, or nullptr if no view in the group has it.
+    TabWidgetPlus *viewOf(const QWidget *page) const;
+
+    // The page with a tab ID, in whichever view has it.
+    QWidget *widgetForId(quint64 id) const;
+
+    /**
+     * @brief Move a page to another view of the group.
+     *
+     * The tab keeps its ID, title, icon, enabled state and visibility,
+     * and lands in front of the visible tab at 'index' in 'to' (at the
+     * end if 'index' is out of range).  Moving within one view works
+     * the same way.
+     *
+     * @return false if no view has the page or 'to' isn't in the group.
+     */
+    bool moveTab(QWidget *page, TabWidgetPlus *to, int index = -1);
+
+signals:
+    void tabMoved(QWidget *page, TabWidgetPlus *from, TabWidgetPlus *to);
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event) override;
+
+private:
+    friend class TabWidgetPlus;
+
+    // Called by the views for pages they start or stop tracking.
+    void track(QWidget *page, TabWidgetPlus *view);
+    void untrack(QWidget *page, bool destroyed);
+    quint64 nextId();
+
+    struct Page {
+        TabWidgetPlus *view = nullptr;
+        QMetaObject::Connection destroyedConnection;
+        QMetaObject::Connection titleConnection;
+    };
+    QHash<const QWidget *, Page> pages;
+    QList<TabWidgetPlus *> viewList;
+    quint64 lastId = 0;
+};
+
+#endif // TABGROUP_H
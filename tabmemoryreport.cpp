@@ -0,0 +1,168 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#include "tabmemoryreport.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLabel>
+#include <QPixmap>
+#include <QSaveFile>
+
+namespace {
+
+// The pixmap a label shows, or a null pixmap.  Qt 5.15 deprecates the
+// pointer-returning QLabel::pixmap(), and Qt 6 returns it by value.
+QPixmap labelPixmap(const QLabel *label)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return label->pixmap();
+#elif QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    return label->pixmap(Qt::ReturnByValue);
+#else
+    auto pixmap = label->pixmap();
+    return nullptr == pixmap ? QPixmap() : *pixmap;
+#endif
+}
+
+} // namespace
+
+qint64 TabMemoryReport::Page::totalBytes() const
+{
+    return objectBytes + pixmapBytes + previewBytes + backingStoreBytes;
+}
+
+qint64 TabMemoryReport::Overhead::totalBytes() const
+{
+    return registryBytes + connectionBytes + eventFilterBytes + queueBytes;
+}
+
+qint64 TabMemoryReport::pageBytes() const
+{
+    qint64 result = 0;
+    for (const auto &page : pages) {
+        result += page.totalBytes();
+    }
+    return result;
+}
+
+qint64 TabMemoryReport::totalBytes() const
+{
+    return pageBytes() + overhead.totalBytes();
+}
+
+double TabMemoryReport::overheadPerTab() const
+{
+    return pages.empty() ? 0.0
+           : double(overhead.totalBytes()) / pages.size();
+}
+
+void TabMemoryReport::measure(QWidget *widget, Page &page)
+{
+    auto objects = widget->findChildren<QObject *>();
+    page.objectCount = objects.size() + 1;
+    page.widgetCount = 1;
+    page.pixmapBytes = 0;
+    auto measurePixmap = [&page](QObject * object) {
+        auto label = qobject_cast<QLabel *>(object);
+        if (nullptr == label) {
+            return;
+        }
+        auto pixmap = labelPixmap(label);
+        if (!pixmap.isNull()) {
+            page.pixmapBytes += qint64(pixmap.width()) * pixmap.height()
+                                * pixmap.depth() / 8;
+        }
+    };
+    measurePixmap(widget);
+    for (auto object : objects) {
+        if (object->isWidgetType()) {
+            ++page.widgetCount;
+        }
+        measurePixmap(object);
+    }
+    page.objectBytes = qint64(page.objectCount) * ObjectCost
+                       + qint64(page.widgetCount) * WidgetCost;
+
+    // Only top-level windows have a backing store; a page paints into
+    // its window's, so it only costs anything while it is on screen.
+    page.backingStoreBytes = widget->isVisible()
+                             ? qint64(widget->width()) * widget->height() * 4 : 0;
+}
+
+QJsonObject TabMemoryReport::toJsonObject() const
+{
+    QJsonArray pageArray;
+    for (const auto &page : pages) {
+        QJsonObject item;
+        item.insert("id", static_cast<qint64>(page.id));
+        item.insert("title", page.title);
+        item.insert("objectName", page.objectName);
+        item.insert("hidden", page.hidden);
+        item.insert("lazy", page.lazy);
+        item.insert("built", page.built);
+        item.insert("lastActivated", static_cast<qint64>(page.lastActivated));
+        item.insert("widgets", page.widgetCount);
+        item.insert("objects", page.objectCount);
+        item.insert("objectBytes", page.objectBytes);
+        item.insert("pixmapBytes", page.pixmapBytes);
+        item.insert("previewBytes", page.previewBytes);
+        item.insert("backingStoreBytes", page.backingStoreBytes);
+        item.insert("totalBytes", page.totalBytes());
+        pageArray.append(item);
+    }
+
+    QJsonObject overheadObject;
+    overheadObject.insert("entries", overhead.entries);
+    overheadObject.insert("connections", overhead.connections);
+    overheadObject.insert("eventFilters", overhead.eventFilters);
+    overheadObject.insert("registryBytes", overhead.registryBytes);
+    overheadObject.insert("connectionBytes", overhead.connectionBytes);
+    overheadObject.insert("eventFilterBytes", overhead.eventFilterBytes);
+    overheadObject.insert("queueBytes", overhead.queueBytes);
+    overheadObject.insert("totalBytes", overhead.totalBytes());
+    overheadObject.insert("bytesPerTab", overheadPerTab());
+
+    QJsonObject result;
+    result.insert("tabs", static_cast<int>(pages.size()));
+    result.insert("pageBytes", pageBytes());
+    result.insert("totalBytes", totalBytes());
+    result.insert("overhead", overheadObject);
+    result.insert("pages", pageArray);
+    return result;
+}
+
+QByteArray TabMemoryReport::toJson() const
+{
+    return QJsonDocument(toJsonObject()).toJson(QJsonDocument::Compact);
+}
+
+bool TabMemoryReport::save(const QString &fileName) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(toJson());
+    return file.commit();
+}
@@ -0,0 +1,118 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#ifndef TABMEMORYREPORT_H
+#define TABMEMORYREPORT_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+class QJsonObject;
+class QWidget;
+
+/**
+ * @brief Estimated memory used by a TabWidgetPlus's pages and by itself.
+ *
+ * Qt doesn't say how much memory a widget holds, so the page figures
+ * are estimates:  a fixed cost per object and per widget in the page's
+ * tree, the pixmaps shown by its labels, its cached preview, and its
+ * share of the window's backing store while it is on screen.  They are
+ * meant for comparing pages (to pick eviction candidates), not for
+ * adding up to what the process uses.
+ *
+ * The overhead figures count what TabWidgetPlus keeps per tab:  its
+ * registry, the two connections and the event filter it puts on every
+ * page, the extra connections on lazy pages, and its work queues.
+ * overheadPerTab() should stay flat however many tabs there are.
+ *
+ * See TabWidgetPlus::memoryReport().
+ */
+struct TabMemoryReport {
+    // Rough per-item costs behind the estimates, in bytes:  a QObject
+    // with its private data, the extra for a QWidget, one connection,
+    // and one entry in a page's event filter list.
+    enum Cost {
+        ObjectCost = 128,
+        WidgetCost = 1024,
+        ConnectionCost = 96,
+        EventFilterCost = 32
+    };
+
+    struct Page {
+        quint64 id = 0;
+        QString title;
+        QString objectName;
+        bool hidden = false;
+        bool lazy = false;
+        // False for a lazy page that isn't built (or was evicted).
+        bool built = true;
+        // Lazy pages only; larger is more recently activated or built.
+        quint64 lastActivated = 0;
+
+        // The page's widget tree, the page itself included.
+        int widgetCount = 0;
+        int objectCount = 0;
+
+        qint64 objectBytes = 0;
+        qint64 pixmapBytes = 0;
+        qint64 previewBytes = 0;
+        qint64 backingStoreBytes = 0;
+
+        qint64 totalBytes() const;
+    };
+
+    struct Overhead {
+        int entries = 0;
+        int connections = 0;
+        int eventFilters = 0;
+
+        qint64 registryBytes = 0;
+        qint64 connectionBytes = 0;
+        qint64 eventFilterBytes = 0;
+        qint64 queueBytes = 0;
+
+        qint64 totalBytes() const;
+    };
+
+    // Every tab, hidden or not, in display order.
+    std::vector<Page> pages;
+    Overhead overhead;
+
+    qint64 pageBytes() const;
+    qint64 totalBytes() const;
+    double overheadPerTab() const;
+
+    // Fill in a Page's tree, pixmap and backing store estimates.
+    static void measure(QWidget *widget, Page &page);
+
+    QJsonObject toJsonObject() const;
+    QByteArray toJson() const;
+
+    // Write toJson() to a file, replacing it in one step so a reader
+    // never sees half a report.
+    bool save(const QString &fileName) const;
+};
+
+#endif // TABMEMORYREPORT_H
@@ -0,0 +1,156 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#include "tabpreviewcache.h"
+#include <QFutureWatcher>
+#include <QImage>
+#include <QWidget>
+#include <QtConcurrent>
+
+TabPreviewCache::TabPreviewCache(QObject *parent) : QObject(parent)
+{
+}
+
+void TabPreviewCache::setMaxBytes(qint64 maxBytes)
+{
+    maxByteCount = maxBytes;
+    trim();
+}
+
+qint64 TabPreviewCache::maxBytes() const
+{
+    return maxByteCount;
+}
+
+qint64 TabPreviewCache::bytes() const
+{
+    return byteCount;
+}
+
+qint64 TabPreviewCache::bytes(QWidget *page) const
+{
+    auto iter = items.constFind(page);
+    return iter == items.constEnd() || !iter->cached ? 0 : iter->bytes;
+}
+
+void TabPreviewCache::setThumbnailSize(const QSize &size)
+{
+    this->size = size;
+}
+
+QSize TabPreviewCache::thumbnailSize() const
+{
+    return size;
+}
+
+void TabPreviewCache::capture(QWidget *page)
+{
+    if (page->width() <= 0 || page->height() <= 0) {
+        // Never laid out, so there is nothing worth showing.
+        return;
+    }
+    capturing = true;
+    auto image = page->grab().toImage();
+    capturing = false;
+
+    auto generation = ++nextGeneration;
+    items[page].generation = generation;
+
+    //
+    // The image is shared copy-on-write with the task, and nothing on
+    // this thread touches it again, so no pixels are copied.
+    //
+    auto targetSize = size;
+    auto watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [ = ]() {
+        store(page, generation, watcher->result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run([image, targetSize]() {
+        return image.scaled(targetSize, Qt::KeepAspectRatio,
+                            Qt::SmoothTransformation);
+    }));
+}
+
+void TabPreviewCache::invalidate(QWidget *page)
+{
+    auto iter = items.find(page);
+    if (iter == items.end()) {
+        return;
+    }
+    drop(iter.value());
+    items.erase(iter);
+}
+
+QPixmap TabPreviewCache::preview(QWidget *page)
+{
+    auto iter = items.find(page);
+    if (iter == items.end() || !iter->cached) {
+        return QPixmap();
+    }
+    lru.splice(lru.begin(), lru, iter->lru);
+    return iter->pixmap;
+}
+
+bool TabPreviewCache::isCapturing() const
+{
+    return capturing;
+}
+
+void TabPreviewCache::store(QWidget *page, quint64 generation,
+                            const QImage &image)
+{
+    auto iter = items.find(page);
+    if (iter == items.end() || iter->generation != generation) {
+        return;
+    }
+    auto &item = iter.value();
+    drop(item);
+    item.generation = generation;
+    item.pixmap = QPixmap::fromImage(image);
+    item.bytes = qint64(image.bytesPerLine()) * image.height();
+    item.lru = lru.insert(lru.begin(), page);
+    item.cached = true;
+    byteCount += item.bytes;
+    trim();
+    if (items.contains(page)) {
+        emit previewReady(page);
+    }
+}
+
+void TabPreviewCache::drop(Item &item)
+{
+    if (item.cached) {
+        byteCount -= item.bytes;
+        lru.erase(item.lru);
+        item.pixmap = QPixmap();
+        item.cached = false;
+    }
+}
+
+void TabPreviewCache::trim()
+{
+    while (byteCount > maxByteCount && !lru.empty()) {
+        invalidate(lru.back());
+    }
+}
@@ -0,0 +1,105 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#ifndef TABPREVIEWCACHE_H
+#define TABPREVIEWCACHE_H
+
+#include <QHash>
+#include <QObject>
+#include <QPixmap>
+#include <QSize>
+#include <list>
+
+class QImage;
+class QWidget;
+
+/**
+ * @brief Bounded cache of small page renders for tab overviews.
+ *
+ * capture() grabs a page on the GUI thread (QWidget::grab() has to run
+ * there) and hands the image to QtConcurrent to be scaled down, so the
+ * GUI thread never pays for the smooth downscale.  Finished previews
+ * are kept least recently used first, and the oldest are dropped once
+ * their total size is over the byte limit.
+ *
+ * A capture that is still being scaled when its page is invalidated or
+ * removed is thrown away when it finishes.
+ */
+class TabPreviewCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TabPreviewCache(QObject *parent = nullptr);
+
+    // Limit on the total size of the cached pixmaps.
+    void setMaxBytes(qint64 maxBytes);
+    qint64 maxBytes() const;
+    qint64 bytes() const;
+
+    // Size of one page's cached preview (0 if it has none), without
+    // marking it recently used.
+    qint64 bytes(QWidget *page) const;
+
+    // Previews are scaled to fit this size, keeping the aspect ratio.
+    void setThumbnailSize(const QSize &size);
+    QSize thumbnailSize() const;
+
+    void capture(QWidget *page);
+    void invalidate(QWidget *page);
+
+    // The cached preview for a page (marking it recently used), or a
+    // null pixmap if there is none.
+    QPixmap preview(QWidget *page);
+
+    // True while capture() is rendering, so that the paint events the
+    // grab itself causes aren't mistaken for the page changing.
+    bool isCapturing() const;
+
+signals:
+    void previewReady(QWidget *page);
+
+private:
+    struct Item {
+        QPixmap pixmap;
+        qint64 bytes = 0;
+        // Bumped by every capture and invalidation; a downscale whose
+        // number no longer matches is out of date.
+        quint64 generation = 0;
+        std::list<QWidget *>::iterator lru;
+        bool cached = false;
+    };
+
+    void store(QWidget *page, quint64 generation, const QImage &image);
+    void drop(Item &item);
+    void trim();
+
+    QHash<QWidget *, Item> items;
+    std::list<QWidget *> lru; // most recently used at the front
+    qint64 maxByteCount = 32 * 1024 * 1024;
+    qint64 byteCount = 0;
+    QSize size = QSize(256, 160);
+    quint64 nextGeneration = 0;
+    bool capturing = false;
+};
+
+#endif // TABPREVIEWCACHE_H
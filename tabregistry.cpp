@@ -0,0 +1,451 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#include "tabregistry.h"
+#include <assert.h>
+
+std::size_t TabRegistry::size() const
+{
+    return countOf(root);
+}
+
+std::size_t TabRegistry::hiddenCount() const
+{
+    return countOf(root) - visibleOf(root);
+}
+
+TabRegistry::Entry *TabRegistry::find(const QWidget *widget) const
+{
+    auto iter = entries.find(widget);
+    if (iter == entries.end()) {
+        return nullptr;
+    }
+    // The map owns the entries; handing out a mutable pointer from a
+    // const lookup mirrors how QTabWidget::widget() behaves.
+    return const_cast<Entry *>(&iter->second);
+}
+
+TabRegistry::Entry *TabRegistry::findId(quint64 id) const
+{
+    return ids.find(id);
+}
+
+quint64 TabRegistry::highestId() const
+{
+    return lastId;
+}
+
+TabRegistry::Entry *TabRegistry::insert(QWidget *widget, Entry *before,
+                                        quint64 id)
+{
+    // std::unordered_map never moves its elements, so the address of
+    // the entry is stable for as long as it stays in the map.
+    auto &entry = entries[widget];
+    assert(nullptr == entry.widget); // already tracked?
+    entry.widget = widget;
+    if (0 == id) {
+        id = ++lastId;
+    } else if (id > lastId) {
+        // Count on from there, so our own IDs never clash with it.
+        lastId = id;
+    }
+    entry.id = id;
+    entry.priority = nextPriority();
+    ids.insert(&entry);
+    link(&entry, before);
+    return &entry;
+}
+
+void TabRegistry::move(Entry *entry, Entry *before)
+{
+    if (entry == before) {
+        return;
+    }
+    unlink(entry);
+    link(entry, before);
+}
+
+void TabRegistry::erase(Entry *entry)
+{
+    unlink(entry);
+    ids.erase(entry->id);
+    entries.erase(entry->widget);
+}
+
+void TabRegistry::setHidden(Entry *entry, bool hidden)
+{
+    if (entry->hidden != hidden) {
+        entry->hidden = hidden;
+        ++changes;
+        updateToRoot(entry);
+    }
+}
+
+int TabRegistry::visibleIndex(const Entry *entry) const
+{
+    //
+    // Count the visible entries in front of this one:  everything in
+    // the left subtree, plus (for every ancestor we reach from its right
+    // side) that ancestor and its own left subtree.
+    //
+    auto result = visibleOf(entry->left);
+    for (auto node = entry; nullptr != node->parent; node = node->parent) {
+        auto parent = node->parent;
+        if (parent->right == node) {
+            result += visibleOf(parent->left) + (parent->hidden ? 0 : 1);
+        }
+    }
+    return static_cast<int>(result);
+}
+
+TabRegistry::Entry *TabRegistry::visibleAt(int index) const
+{
+    if (index < 0) {
+        return nullptr;
+    }
+    auto remaining = static_cast<std::size_t>(index);
+    auto node = root;
+    while (nullptr != node) {
+        auto leftVisible = visibleOf(node->left);
+        if (remaining < leftVisible) {
+            node = node->left;
+        } else if (remaining == leftVisible && !node->hidden) {
+            return node;
+        } else {
+            remaining -= leftVisible + (node->hidden ? 0 : 1);
+            node = node->right;
+        }
+    }
+    return nullptr;
+}
+
+TabRegistry::Entry *TabRegistry::first() const
+{
+    auto node = root;
+    while (nullptr != node && nullptr != node->left) {
+        node = node->left;
+    }
+    return node;
+}
+
+TabRegistry::Entry *TabRegistry::next(const Entry *entry) const
+{
+    if (nullptr != entry->right) {
+        auto node = entry->right;
+        while (nullptr != node->left) {
+            node = node->left;
+        }
+        return node;
+    }
+    // No right subtree:  climb until we come up from a left child.
+    auto node = const_cast<Entry *>(entry);
+    while (nullptr != node->parent && node->parent->right == node) {
+        node = node->parent;
+    }
+    return node->parent;
+}
+
+TabRegistry::Entry *TabRegistry::firstHidden() const
+{
+    return leftmostHidden(root);
+}
+
+TabRegistry::Entry *TabRegistry::nextHidden(const Entry *entry) const
+{
+    //
+    // Like next(), but a subtree without hidden entries is passed over
+    // whole:  the first hidden entry after this one is either in its
+    // right subtree, or an ancestor we reach from the left, or in that
+    // ancestor's right subtree.
+    //
+    if (0 != hiddenOf(entry->right)) {
+        return leftmostHidden(entry->right);
+    }
+    auto node = const_cast<Entry *>(entry);
+    for (; nullptr != node->parent; node = node->parent) {
+        auto parent = node->parent;
+        if (parent->left != node) {
+            continue;
+        }
+        if (parent->hidden) {
+            return parent;
+        }
+        if (0 != hiddenOf(parent->right)) {
+            return leftmostHidden(parent->right);
+        }
+    }
+    return nullptr;
+}
+
+TabRegistry::HiddenRange TabRegistry::hiddenEntries() const
+{
+    return HiddenRange(this);
+}
+
+quint64 TabRegistry::generation() const
+{
+    return changes;
+}
+
+std::size_t TabRegistry::memoryBytes() const
+{
+    // Each map node holds the key, the entry and (in the usual
+    // implementations) a next pointer and the cached hash.
+    typedef std::unordered_map<const QWidget *, Entry>::value_type Node;
+    return entries.size() * (sizeof(Node) + 2 * sizeof(void *))
+           + entries.bucket_count() * sizeof(void *) + ids.memoryBytes();
+}
+
+unsigned TabRegistry::nextPriority()
+{
+    // xorshift32: cheap, deterministic, and good enough for balancing.
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+std::size_t TabRegistry::countOf(const Entry *node)
+{
+    return nullptr == node ? 0 : node->count;
+}
+
+std::size_t TabRegistry::visibleOf(const Entry *node)
+{
+    return nullptr == node ? 0 : node->visible;
+}
+
+std::size_t TabRegistry::hiddenOf(const Entry *node)
+{
+    return countOf(node) - visibleOf(node);
+}
+
+TabRegistry::Entry *TabRegistry::leftmostHidden(Entry *node)
+{
+    if (0 == hiddenOf(node)) {
+        return nullptr;
+    }
+    for (;;) {
+        if (0 != hiddenOf(node->left)) {
+            node = node->left;
+        } else if (node->hidden) {
+            return node;
+        } else {
+            node = node->right;
+        }
+    }
+}
+
+void TabRegistry::update(Entry *node)
+{
+    node->count = 1 + countOf(node->left) + countOf(node->right);
+    node->visible = (node->hidden ? 0 : 1)
+                    + visibleOf(node->left) + visibleOf(node->right);
+    if (nullptr != node->left) {
+        node->left->parent = node;
+    }
+    if (nullptr != node->right) {
+        node->right->parent = node;
+    }
+}
+
+void TabRegistry::updateToRoot(Entry *node)
+{
+    for (; nullptr != node; node = node->parent) {
+        update(node);
+    }
+}
+
+std::size_t TabRegistry::position(const Entry *node)
+{
+    auto result = countOf(node->left);
+    for (; nullptr != node->parent; node = node->parent) {
+        if (node->parent->right == node) {
+            result += countOf(node->parent->left) + 1;
+        }
+    }
+    return result;
+}
+
+void TabRegistry::split(Entry *node, std::size_t leftCount,
+                        Entry *&leftTree, Entry *&rightTree)
+{
+    if (nullptr == node) {
+        leftTree = rightTree = nullptr;
+        return;
+    }
+    node->parent = nullptr;
+    if (countOf(node->left) < leftCount) {
+        split(node->right, leftCount - countOf(node->left) - 1,
+              node->right, rightTree);
+        leftTree = node;
+    } else {
+        split(node->left, leftCount, leftTree, node->left);
+        rightTree = node;
+    }
+    update(node);
+}
+
+TabRegistry::Entry *TabRegistry::merge(Entry *leftTree, Entry *rightTree)
+{
+    if (nullptr == leftTree || nullptr == rightTree) {
+        return nullptr == leftTree ? rightTree : leftTree;
+    }
+    if (leftTree->priority > rightTree->priority) {
+        leftTree->right = merge(leftTree->right, rightTree);
+        update(leftTree);
+        return leftTree;
+    }
+    rightTree->left = merge(leftTree, rightTree->left);
+    update(rightTree);
+    return rightTree;
+}
+
+void TabRegistry::link(Entry *entry, Entry *before)
+{
+    ++changes;
+    entry->parent = entry->left = entry->right = nullptr;
+    update(entry);
+    if (nullptr == before) {
+        root = merge(root, entry);
+    } else {
+        Entry *leftTree = nullptr;
+        Entry *rightTree = nullptr;
+        split(root, position(before), leftTree, rightTree);
+        root = merge(merge(leftTree, entry), rightTree);
+    }
+    root->parent = nullptr;
+}
+
+void TabRegistry::unlink(Entry *entry)
+{
+    ++changes;
+    //
+    // Replace the entry with the merge of its two subtrees, then fix the
+    // counts on the way back up to the root.
+    //
+    auto parent = entry->parent;
+    auto replacement = merge(entry->left, entry->right);
+    if (nullptr != replacement) {
+        replacement->parent = parent;
+    }
+    if (nullptr == parent) {
+        root = replacement;
+    } else {
+        if (parent->left == entry) {
+            parent->left = replacement;
+        } else {
+            parent->right = replacement;
+        }
+        updateToRoot(parent);
+    }
+    entry->parent = entry->left = entry->right = nullptr;
+}
+
+std::size_t TabRegistry::IdIndex::home(quint64 id) const
+{
+    // Fibonacci hashing:  IDs are sequential, and multiplying spreads
+    // them over the table.
+    return static_cast<std::size_t>((id * 0x9E3779B97F4A7C15ull) >> 32)
+           & (buckets.size() - 1);
+}
+
+TabRegistry::Entry *TabRegistry::IdIndex::find(quint64 id) const
+{
+    if (buckets.empty() || 0 == id) {
+        return nullptr;
+    }
+    auto mask = buckets.size() - 1;
+    for (auto i = home(id); 0 != buckets[i].id; i = (i + 1) & mask) {
+        if (id == buckets[i].id) {
+            return buckets[i].entry;
+        }
+    }
+    return nullptr;
+}
+
+void TabRegistry::IdIndex::insert(Entry *entry)
+{
+    if (2 * (used + 1) > buckets.size()) {
+        grow();
+    }
+    auto mask = buckets.size() - 1;
+    auto i = home(entry->id);
+    while (0 != buckets[i].id) {
+        i = (i + 1) & mask;
+    }
+    buckets[i].id = entry->id;
+    buckets[i].entry = entry;
+    ++used;
+}
+
+void TabRegistry::IdIndex::erase(quint64 id)
+{
+    if (buckets.empty()) {
+        return;
+    }
+    auto mask = buckets.size() - 1;
+    auto hole = home(id);
+    while (id != buckets[hole].id) {
+        if (0 == buckets[hole].id) {
+            return;
+        }
+        hole = (hole + 1) & mask;
+    }
+
+    //
+    // Walk the rest of the run.  Anything whose home is not between
+    // the hole and itself (cyclically) would be cut off from its home
+    // by the hole, so it moves back into it, and its old place becomes
+    // the new hole.
+    //
+    for (auto i = (hole + 1) & mask; 0 != buckets[i].id; i = (i + 1) & mask) {
+        auto wanted = home(buckets[i].id);
+        auto reachable = hole < i ? (hole < wanted && wanted <= i)
+                         : (hole < wanted || wanted <= i);
+        if (!reachable) {
+            buckets[hole] = buckets[i];
+            hole = i;
+        }
+    }
+    buckets[hole] = Bucket();
+    --used;
+}
+
+std::size_t TabRegistry::IdIndex::memoryBytes() const
+{
+    return buckets.capacity() * sizeof(Bucket);
+}
+
+void TabRegistry::IdIndex::grow()
+{
+    std::vector<Bucket> old;
+    old.swap(buckets);
+    buckets.resize(old.empty() ? 16 : old.size() * 2);
+    used = 0;
+    for (const auto &bucket : old) {
+        if (0 != bucket.id) {
+            insert(bucket.entry);
+        }
+    }
+}
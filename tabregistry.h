@@ -0,0 +1,253 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#ifndef TABREGISTRY_H
+#define TABREGISTRY_H
+
+#include <QObject>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+class QWidget;
+
+/**
+ * @brief Ordered index of every tab known to a TabWidgetPlus.
+ *
+ * Visible and hidden tabs are kept together in a single sequence, in the
+ * order they would appear if every tab were shown.  The index a hidden
+ * tab returns to is simply the number of visible tabs in front of it, so
+ * inserting or removing a visible tab never has to touch the hidden
+ * entries that follow it.
+ *
+ * The sequence is an implicit treap (a randomized balanced tree ordered
+ * by position) whose nodes count the visible entries below them, which
+ * makes every positional operation O(log n).  Entries are owned by a hash
+ * map keyed on the widget pointer, so finding an entry is O(1).
+ */
+class TabRegistry
+{
+public:
+    struct Entry {
+        QWidget *widget = nullptr;
+        bool hidden = false;
+
+        // Stable tab ID, never 0 and never handed out twice.
+        quint64 id = 0;
+
+        // The hooks TabWidgetPlus keeps on the widget.  They live exactly
+        // as long as the entry, so nothing is left behind once the widget
+        // is gone.
+        QMetaObject::Connection destroyedConnection;
+        QMetaObject::Connection titleConnection;
+        bool widgetDestroyed = false;
+
+        // Hidden by TabWidgetPlus::setFilter() rather than hideTab(),
+        // so clearing the filter brings it back.
+        bool filteredOut = false;
+
+        // Tab bar changes waiting for TabWidgetPlus to flush them.
+        unsigned char dirty = 0;
+
+        // Activity level TabWidgetPlus last published for the tab
+        // (0xff until the first one).
+        unsigned char activity = 0xff;
+
+    private:
+        friend class TabRegistry;
+        Entry *parent = nullptr;
+        Entry *left = nullptr;
+        Entry *right = nullptr;
+        unsigned priority = 0;
+        std::size_t count = 1;
+        std::size_t visible = 1;
+    };
+
+    TabRegistry() = default;
+    TabRegistry(const TabRegistry &) = delete;
+    TabRegistry &operator=(const TabRegistry &) = delete;
+
+    // Number of entries (visible and hidden) and of hidden entries.
+    std::size_t size() const;
+    std::size_t hiddenCount() const;
+
+    // Find the entry for a widget, or nullptr if it isn't tracked.
+    Entry *find(const QWidget *widget) const;
+
+    // Find the entry with a tab ID, or nullptr if there is none (any
+    // more).
+    Entry *findId(quint64 id) const;
+
+    // The largest tab ID this registry has given out or taken in.
+    quint64 highestId() const;
+
+    // Add a visible entry for widget immediately in front of 'before'.
+    // A null 'before' appends the entry at the end of the sequence.
+    // The entry gets the next tab ID, or 'id' if it is not 0 (an ID
+    // handed out elsewhere, which must not be in use here).
+    Entry *insert(QWidget *widget, Entry *before, quint64 id = 0);
+
+    // Move an existing entry so it sits immediately in front of 'before'
+    // (or at the end).  The entry keeps its identity and hidden flag.
+    void move(Entry *entry, Entry *before);
+
+    void erase(Entry *entry);
+    void setHidden(Entry *entry, bool hidden);
+
+    // Number of visible entries in front of this one.  For a visible
+    // entry this is its tab index; for a hidden entry it is the index
+    // the tab will be shown at.
+    int visibleIndex(const Entry *entry) const;
+
+    // The visible entry with the given tab index, or nullptr.
+    Entry *visibleAt(int index) const;
+
+    // Walk the entries in display order:  first() is nullptr when the
+    // registry is empty and next() is nullptr after the last entry.
+    Entry *first() const;
+    Entry *next(const Entry *entry) const;
+
+    // The same walk over the hidden entries only, skipping whole runs
+    // of visible entries at once (O(log n) per step).
+    Entry *firstHidden() const;
+    Entry *nextHidden(const Entry *entry) const;
+
+    //
+    // The hidden entries' widgets as a range for range-based for loops.
+    // It holds nothing but a pointer to the registry, so it costs no
+    // allocation, and like the walk above it is only good until the
+    // registry next changes.
+    //
+    class HiddenRange
+    {
+    public:
+        class iterator
+        {
+        public:
+            iterator(const TabRegistry *registry, const Entry *entry)
+                : registry(registry), entry(entry) {}
+            QWidget *operator*() const
+            {
+                return entry->widget;
+            }
+            iterator &operator++()
+            {
+                entry = registry->nextHidden(entry);
+                return *this;
+            }
+            bool operator==(const iterator &other) const
+            {
+                return entry == other.entry;
+            }
+            bool operator!=(const iterator &other) const
+            {
+                return entry != other.entry;
+            }
+
+        private:
+            const TabRegistry *registry;
+            const Entry *entry;
+        };
+
+        explicit HiddenRange(const TabRegistry *registry) : registry(registry) {}
+        iterator begin() const
+        {
+            return iterator(registry, registry->firstHidden());
+        }
+        iterator end() const
+        {
+            return iterator(registry, nullptr);
+        }
+        std::size_t size() const
+        {
+            return registry->hiddenCount();
+        }
+        bool empty() const
+        {
+            return 0 == size();
+        }
+
+    private:
+        const TabRegistry *registry;
+    };
+    HiddenRange hiddenEntries() const;
+
+    // Bumped by every change to the order or hidden flags, so callers
+    // can tell that nothing has changed without walking anything.
+    quint64 generation() const;
+
+    // Heap bytes the registry holds:  the entries with their hash map
+    // nodes and buckets, and the tab ID index.  The bucket arrays
+    // follow the most entries held at once; they don't shrink.
+    std::size_t memoryBytes() const;
+
+private:
+    //
+    // Flat open-addressing table (linear probing, kept at most half
+    // full) from tab ID to entry.  Erasing shifts the following run
+    // back instead of leaving tombstones, so lookups stay short no
+    // matter how many tabs have come and gone.
+    //
+    class IdIndex
+    {
+    public:
+        Entry *find(quint64 id) const;
+        void insert(Entry *entry);
+        void erase(quint64 id);
+        std::size_t memoryBytes() const;
+
+    private:
+        struct Bucket {
+            quint64 id = 0; // 0 marks an empty bucket
+            Entry *entry = nullptr;
+        };
+        std::vector<Bucket> buckets;
+        std::size_t used = 0;
+
+        std::size_t home(quint64 id) const;
+        void grow();
+    };
+
+    std::unordered_map<const QWidget *, Entry> entries;
+    IdIndex ids;
+    quint64 lastId = 0;
+    quint64 changes = 0;
+    Entry *root = nullptr;
+    unsigned seed = 2463534242u;
+
+    unsigned nextPriority();
+    static std::size_t countOf(const Entry *node);
+    static std::size_t visibleOf(const Entry *node);
+    static std::size_t hiddenOf(const Entry *node);
+    static Entry *leftmostHidden(Entry *node);
+    static void update(Entry *node);
+    static void updateToRoot(Entry *node);
+    static std::size_t position(const Entry *node);
+    static void split(Entry *node, std::size_t leftCount,
+                      Entry *&leftTree, Entry *&rightTree);
+    static Entry *merge(Entry *leftTree, Entry *rightTree);
+    void link(Entry *entry, Entry *before);
+    void unlink(Entry *entry);
+};
+
+#endif // TABREGISTRY_H
@@ -0,0 +1,104 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#include "tabsearchpopup.h"
+#include <QLineEdit>
+#include <QListView>
+#include <QSortFilterProxyModel>
+#include <QStringListModel>
+#include <QStyle>
+#include <QTabWidget>
+#include <QVBoxLayout>
+
+TabSearchPopup::TabSearchPopup(QTabWidget *tabWidget)
+    : QFrame(tabWidget, Qt::Popup), tabWidget(tabWidget)
+{
+    setFrameShape(QFrame::StyledPanel);
+
+    filterEdit = new QLineEdit(this);
+    filterEdit->setPlaceholderText(tr("Find tab"));
+    filterEdit->setClearButtonEnabled(true);
+
+    titles = new QStringListModel(this);
+    filter = new QSortFilterProxyModel(this);
+    filter->setSourceModel(titles);
+    filter->setFilterCaseSensitivity(Qt::CaseInsensitive);
+
+    listView = new QListView(this);
+    listView->setModel(filter);
+    listView->setUniformItemSizes(true);
+    listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    auto popupLayout = new QVBoxLayout(this);
+    popupLayout->setContentsMargins(4, 4, 4, 4);
+    popupLayout->addWidget(filterEdit);
+    popupLayout->addWidget(listView);
+
+    connect(filterEdit, &QLineEdit::textChanged,
+            filter, &QSortFilterProxyModel::setFilterFixedString);
+    connect(filterEdit, &QLineEdit::returnPressed,
+            this, &TabSearchPopup::chooseFirstRow);
+    connect(listView, &QListView::activated, this, &TabSearchPopup::chooseRow);
+
+    // A popup should take a single click, which most styles only report
+    // as clicked().  Where the style activates on a single click too,
+    // listening to both would choose the row twice.
+    if (!listView->style()->styleHint(QStyle::SH_ItemView_ActivateItemOnSingleClick,
+                                      nullptr, listView)) {
+        connect(listView, &QListView::clicked, this, &TabSearchPopup::chooseRow);
+    }
+}
+
+void TabSearchPopup::popup(const QPoint &globalPos)
+{
+    // Row numbers in the model match the tab indexes, since only
+    // tabs in the tab bar are listed.
+    QStringList tabTitles;
+    auto total = tabWidget->count();
+    tabTitles.reserve(total);
+    for (auto index = 0; index < total; ++index) {
+        tabTitles.append(tabWidget->tabText(index));
+    }
+    titles->setStringList(tabTitles);
+    filterEdit->clear();
+
+    resize(320, 400);
+    move(globalPos);
+    show();
+    filterEdit->setFocus();
+}
+
+void TabSearchPopup::chooseRow(const QModelIndex &proxyIndex)
+{
+    auto sourceIndex = filter->mapToSource(proxyIndex);
+    if (sourceIndex.isValid() && sourceIndex.row() < tabWidget->count()) {
+        tabWidget->setCurrentIndex(sourceIndex.row());
+    }
+    hide();
+}
+
+void TabSearchPopup::chooseFirstRow()
+{
+    auto current = listView->currentIndex();
+    chooseRow(current.isValid() ? current : filter->index(0, 0));
+}
@@ -0,0 +1,65 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#ifndef TABSEARCHPOPUP_H
+#define TABSEARCHPOPUP_H
+
+#include <QFrame>
+
+class QLineEdit;
+class QListView;
+class QModelIndex;
+class QSortFilterProxyModel;
+class QStringListModel;
+class QTabWidget;
+
+/**
+ * @brief Popup listing every tab of a tab widget, filtered as you type.
+ *
+ * The list is a QListView, which only creates and paints the rows on
+ * screen, so it stays quick with tens of thousands of tabs.  Choosing a
+ * row makes that tab current and closes the popup.
+ */
+class TabSearchPopup : public QFrame
+{
+    Q_OBJECT
+public:
+    explicit TabSearchPopup(QTabWidget *tabWidget);
+    virtual ~TabSearchPopup() = default;
+
+    // Reload the tab titles and show the popup at the given position.
+    void popup(const QPoint &globalPos);
+
+private slots:
+    void chooseRow(const QModelIndex &proxyIndex);
+    void chooseFirstRow();
+
+private:
+    QTabWidget *tabWidget = nullptr;
+    QLineEdit *filterEdit = nullptr;
+    QListView *listView = nullptr;
+    QStringListModel *titles = nullptr;
+    QSortFilterProxyModel *filter = nullptr;
+};
+
+#endif // TABSEARCHPOPUP_H
@@ -0,0 +1,632 @@
+#include "tabstressdriver.h"
+#include "lazytabpage.h"
+#include "tabtimerthrottle.h"
+#include "tabwidgetplus.h"
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTimer>
+#include <algorithm>
+#include <random>
+
+namespace {
+
+const char *const actionNames[] = {
+    "create", "insert", "delete", "hide", "show", "enable", "disable", "retitle",
+    "move", "remove"
+};
+const int actionCount = sizeof(actionNames) / sizeof(actionNames[0]);
+
+QString describe(const TabStressDriver::Step &step)
+{
+    return QString(actionNames[static_cast<int>(step.action)]) + " "
+           + QString::number(step.argument);
+}
+
+//
+// Turns a seed into steps.  The mix leans towards hide/show, since the
+// hidden tab bookkeeping is what this is here to exercise.
+//
+class StepSource
+{
+public:
+    explicit StepSource(quint32 seed) : rng(seed) {}
+
+    TabStressDriver::Step next()
+    {
+        typedef TabStressDriver::Action Action;
+        static const Action weighted[] = {
+            Action::Create, Action::Create, Action::Create,
+            Action::Insert, Action::Insert,
+            Action::Delete, Action::Delete, Action::Delete,
+            Action::Hide, Action::Hide, Action::Hide, Action::Hide,
+            Action::Show, Action::Show, Action::Show, Action::Show,
+            Action::Enable, Action::Disable,
+            Action::Retitle, Action::Retitle,
+            Action::Move, Action::Move,
+            Action::Remove
+        };
+        const auto choices = sizeof(weighted) / sizeof(weighted[0]);
+        TabStressDriver::Step step;
+        step.action = weighted[rng() % choices];
+        step.argument = rng();
+        return step;
+    }
+
+private:
+    std::mt19937 rng;
+};
+
+} // namespace
+
+//
+// A TabWidgetPlus and the list of tabs it should have.
+//
+class TabStressDriver::StressRun
+{
+public:
+    explicit StressRun(int maxTabs) : maxTabs(maxTabs) {}
+
+    // Delete every tab, leaving the tab widget empty.
+    void clear()
+    {
+        for (const auto &tab : model) {
+            delete tab.widget;
+        }
+        model.clear();
+    }
+
+    // Apply one step and check the result.  Returns what went wrong, or
+    // an empty string if the tab widget still matches the model.
+    QString apply(const TabStressDriver::Step &step)
+    {
+        typedef TabStressDriver::Action Action;
+        auto action = step.action;
+        auto live = static_cast<int>(model.size());
+        if (0 == live) {
+            action = Action::Create;
+        } else if (maxTabs <= live
+                   && (Action::Create == action || Action::Insert == action)) {
+            action = Action::Delete;
+        }
+
+        switch (action) {
+        case Action::Create:
+        case Action::Insert: {
+            auto page = new QWidget;
+            auto title = "Tab " + QString::number(nextTabNumber++);
+            auto position = model.end();
+            if (Action::Insert == action) {
+                auto index = static_cast<int>(step.argument % (visibleCount() + 1));
+                position = visibleAt(index);
+                tabWidget.insertTab(index, page, title);
+            } else {
+                tabWidget.addTab(page, title);
+            }
+            Tab tab;
+            tab.widget = page;
+            tab.title = title;
+            model.insert(position, tab);
+            break;
+        }
+        case Action::Delete: {
+            auto position = model.begin() + step.argument % live;
+            delete position->widget;
+            model.erase(position);
+            break;
+        }
+        case Action::Hide:
+        case Action::Show: {
+            auto &tab = model[step.argument % live];
+            tab.hidden = Action::Hide == action;
+            if (tab.hidden) {
+                tabWidget.hideTab(tab.widget);
+            } else {
+                tabWidget.showTab(tab.widget);
+            }
+            break;
+        }
+        case Action::Enable:
+        case Action::Disable: {
+            auto &tab = model[step.argument % live];
+            tab.enabled = Action::Enable == action;
+            tab.widget->setEnabled(tab.enabled);
+            break;
+        }
+        case Action::Move: {
+            // The low and high halves of the argument pick the two
+            // visible tabs, the same way a drag would.
+            auto visible = visibleCount();
+            if (0 == visible) {
+                break;
+            }
+            auto from = static_cast<int>((step.argument & 0xffff) % visible);
+            auto to = static_cast<int>((step.argument >> 16) % visible);
+            tabWidget.tabBar()->moveTab(from, to);
+
+            // Take the tab out, then put it in front of whichever
+            // visible tab now has index 'to' (or at the very end).
+            auto moving = visibleAt(from);
+            auto tab = *moving;
+            model.erase(moving);
+            model.insert(visibleAt(to), tab);
+            break;
+        }
+        case Action::Remove: {
+            auto visible = visibleCount();
+            if (0 == visible) {
+                break;
+            }
+            auto index = static_cast<int>(step.argument % visible);
+            auto position = visibleAt(index);
+            auto page = position->widget;
+            tabWidget.removeTab(index);
+            model.erase(position);
+
+            // The tab widget has let go of the page, so it is ours to
+            // delete, and deleting it must not reach the tab widget.
+            if (TabWidgetPlus::tabWidgetState::unknown != tabWidget.tabState(page)) {
+                return "removed tab is still tracked";
+            }
+            delete page;
+            break;
+        }
+        case Action::Retitle: {
+            auto &tab = model[step.argument % live];
+            tab.title = "Title " + QString::number(step.argument % 1000);
+            tab.widget->setWindowTitle(tab.title);
+            break;
+        }
+        }
+        return check();
+    }
+
+private:
+    struct Tab {
+        QWidget *widget = nullptr;
+        bool hidden = false;
+        bool enabled = true;
+        QString title;
+    };
+    typedef std::vector<Tab> Model;
+
+    TabWidgetPlus tabWidget;
+    Model model;
+    int maxTabs;
+    int nextTabNumber = 0;
+
+    int visibleCount() const
+    {
+        return static_cast<int>(std::count_if(model.begin(), model.end(),
+        [](const Tab & tab) {
+            return !tab.hidden;
+        }));
+    }
+
+    // Where a tab inserted at 'index' goes:  in front of the visible tab
+    // now at that index, or at the very end.
+    Model::iterator visibleAt(int index)
+    {
+        for (auto iter = model.begin(); iter != model.end(); ++iter) {
+            if (!iter->hidden && 0 == index--) {
+                return iter;
+            }
+        }
+        return model.end();
+    }
+
+    QString check() const
+    {
+        if (tabWidget.count() != visibleCount()) {
+            return "count() is " + QString::number(tabWidget.count())
+                   + ", expected " + QString::number(visibleCount());
+        }
+        auto index = 0;
+        for (const auto &tab : model) {
+            auto state = tabWidget.tabState(tab.widget);
+            if (tab.hidden) {
+                if (TabWidgetPlus::tabWidgetState::hidden != state
+                        || -1 != tabWidget.indexOf(tab.widget)) {
+                    return "\"" + tab.title + "\" should be hidden";
+                }
+                continue;
+            }
+            if (tabWidget.widget(index) != tab.widget) {
+                return "tab " + QString::number(index) + " is \""
+                       + tabWidget.tabText(index) + "\", expected \""
+                       + tab.title + "\"";
+            }
+            if (TabWidgetPlus::tabWidgetState::visible != state
+                    || tabWidget.indexOf(tab.widget) != index) {
+                return "\"" + tab.title + "\" is not visible at "
+                       + QString::number(index);
+            }
+            if (tabWidget.tabText(index) != tab.title) {
+                return "tab " + QString::number(index) + " reads \""
+                       + tabWidget.tabText(index) + "\", expected \""
+                       + tab.title + "\"";
+            }
+            if (tabWidget.isTabEnabled(index) != tab.enabled) {
+                return "tab " + QString::number(index)
+                       + (tab.enabled ? " should be enabled"
+                          : " should be disabled");
+            }
+            ++index;
+        }
+        if (!tabWidget.checkConsistency()) {
+            return "checkConsistency() failed";
+        }
+        return QString();
+    }
+};
+
+TabStressDriver::TabStressDriver(int maxTabs) : maxTabs(std::max(maxTabs, 1))
+{
+}
+
+TabStressDriver::~TabStressDriver()
+{
+}
+
+TabStressDriver::Trace TabStressDriver::generate(quint32 seed, quint64 steps)
+{
+    StepSource source(seed);
+    Trace result;
+    result.reserve(static_cast<std::size_t>(steps));
+    for (quint64 i = 0; i < steps; ++i) {
+        result.push_back(source.next());
+    }
+    return result;
+}
+
+TabStressDriver::Result TabStressDriver::run(quint32 seed, quint64 steps) const
+{
+    Result result;
+    StepSource source(seed);
+    StressRun stressRun(maxTabs);
+
+    QElapsedTimer timer;
+    timer.start();
+    while (result.steps < steps && result.failure.isEmpty()) {
+        auto step = source.next();
+        ++result.steps;
+        auto failure = stressRun.apply(step);
+        if (!failure.isEmpty()) {
+            result.failure = "step " + QString::number(result.steps) + " ("
+                             + describe(step) + "): " + failure;
+        }
+    }
+    result.nsecs = timer.nsecsElapsed();
+
+    if (!result.failure.isEmpty()) {
+        result.minimized = minimize(generate(seed, result.steps));
+    }
+    return result;
+}
+
+TabStressDriver::Result TabStressDriver::replay(const Trace &trace) const
+{
+    Result result;
+    StressRun stressRun(maxTabs);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (const auto &step : trace) {
+        ++result.steps;
+        auto failure = stressRun.apply(step);
+        if (!failure.isEmpty()) {
+            result.failure = "step " + QString::number(result.steps) + " ("
+                             + describe(step) + "): " + failure;
+            result.minimized.assign(trace.begin(),
+                                    trace.begin() + result.steps);
+            break;
+        }
+    }
+    result.nsecs = timer.nsecsElapsed();
+    return result;
+}
+
+TabStressDriver::Result TabStressDriver::replayReusing(const Trace &trace)
+{
+    if (!reusedRun) {
+        reusedRun.reset(new StressRun(maxTabs));
+    }
+    reusedRun->clear();
+
+    Result result;
+    for (const auto &step : trace) {
+        ++result.steps;
+        auto failure = reusedRun->apply(step);
+        if (!failure.isEmpty()) {
+            result.failure = "step " + QString::number(result.steps) + " ("
+                             + describe(step) + "): " + failure;
+            result.minimized.assign(trace.begin(),
+                                    trace.begin() + result.steps);
+            break;
+        }
+    }
+    return result;
+}
+
+TabStressDriver::Trace TabStressDriver::decode(const unsigned char *data, std::size_t size)
+{
+    //
+    // Whole steps only:  the last size % 3 bytes are ignored, so inputs
+    // that differ only in those bytes run the same trace.  libFuzzer
+    // still mutates them, but it notices they cover nothing new.
+    //
+    Trace result;
+    result.reserve(size / 3);
+    for (std::size_t i = 0; i + 3 <= size; i += 3) {
+        Step step;
+        step.action = static_cast<Action>(data[i] % actionCount);
+        step.argument = quint32(data[i + 1]) | quint32(data[i + 2]) << 16;
+        result.push_back(step);
+    }
+    return result;
+}
+
+TabStressDriver::Trace TabStressDriver::minimize(const Trace &failing) const
+{
+    //
+    // ddmin, complements only:  cut the trace into 'chunks' pieces and
+    // try dropping each piece in turn.  Keep any smaller trace that still
+    // fails; otherwise cut finer, until the pieces are single steps.
+    //
+    auto trace = failing;
+    std::size_t chunks = 2;
+    while (2 <= trace.size()) {
+        auto chunkSize = (trace.size() + chunks - 1) / chunks;
+        auto reduced = false;
+        for (std::size_t start = 0; start < trace.size(); start += chunkSize) {
+            Trace candidate(trace.begin(), trace.begin() + start);
+            auto end = std::min(start + chunkSize, trace.size());
+            candidate.insert(candidate.end(), trace.begin() + end, trace.end());
+
+            auto result = replay(candidate);
+            if (!result.failure.isEmpty()) {
+                trace = result.minimized;
+                chunks = std::max<std::size_t>(chunks - 1, 2);
+                reduced = true;
+                break;
+            }
+        }
+        if (!reduced) {
+            if (trace.size() <= chunks) {
+                break;
+            }
+            chunks = std::min(chunks * 2, trace.size());
+        }
+    }
+    return trace;
+}
+
+QString TabStressDriver::format(const Trace &trace)
+{
+    QString result;
+    for (const auto &step : trace) {
+        result += describe(step) + "\n";
+    }
+    return result;
+}
+
+TabStressDriver::Trace TabStressDriver::parse(const QString &text, bool *ok)
+{
+    Trace result;
+    auto valid = true;
+    for (const auto &rawLine : text.split('\n')) {
+        auto line = rawLine.trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        auto fields = line.split(' ', Qt::SkipEmptyParts);
+#else
+        auto fields = line.split(' ', QString::SkipEmptyParts);
+#endif
+        auto action = -1;
+        for (auto i = 0; i < actionCount; ++i) {
+            if (fields.value(0) == actionNames[i]) {
+                action = i;
+            }
+        }
+        auto argumentOk = false;
+        auto argument = fields.value(1).toUInt(&argumentOk);
+        if (2 != fields.size() || -1 == action || !argumentOk) {
+            valid = false;
+            continue;
+        }
+        Step step;
+        step.action = static_cast<Action>(action);
+        step.argument = argument;
+        result.push_back(step);
+    }
+    if (nullptr != ok) {
+        *ok = valid;
+    }
+    return result;
+}
+
+QString TabStressDriver::report(const Result &result)
+{
+    auto seconds = result.nsecs / 1e9;
+    auto rate = 0 < seconds ? result.steps / seconds : 0.0;
+    auto text = QString::number(result.steps) + " steps in "
+                + QString::number(seconds, 'f', 3) + " s ("
+                + QString::number(rate, 'f', 0) + " ops/s)\n";
+    if (result.failure.isEmpty()) {
+        return text + "passed\n";
+    }
+    return text + "FAILED at " + result.failure + "\n"
+           + "# minimized trace (" + QString::number(result.minimized.size())
+           + " steps):\n" + format(result.minimized);
+}
+
+namespace {
+
+// A hidden tab keeps the title it had, even one still waiting for a
+// coalesced update.
+QString retitleHideShow()
+{
+    TabWidgetPlus tabWidget;
+    tabWidget.setCoalescedUpdates(true, 60000);
+    auto page = new QWidget;
+    tabWidget.addTab(new QWidget, "Before");
+    tabWidget.addTab(page, "Old");
+    page->setWindowTitle("New");
+    tabWidget.hideTab(page);
+    tabWidget.showTab(page);
+    tabWidget.setCoalescedUpdates(false);
+    auto text = tabWidget.tabText(tabWidget.indexOf(page));
+    return text == "New" ? QString() : "tab reads \"" + text + "\"";
+}
+
+// Tabs the filter hides stay the filter's across restoreLayout(), both
+// those in the layout and those left out of it.
+QString restoreWhileFiltered()
+{
+    TabWidgetPlus tabWidget;
+    std::vector<QWidget *> pages;
+    const char *names[] = {"a", "b", "c"};
+    const char *titles[] = {"keep a", "drop b", "keep c"};
+    for (auto i = 0; i < 3; ++i) {
+        pages.push_back(new QWidget);
+        pages.back()->setObjectName(names[i]);
+        tabWidget.addTab(pages.back(), titles[i]);
+    }
+    tabWidget.setFilter(QRegularExpression("keep"));
+    auto full = tabWidget.saveLayout();
+
+    TabWidgetPlus other;
+    auto page = new QWidget;
+    page->setObjectName("a");
+    other.addTab(page, "keep a");
+    auto partial = other.saveLayout();
+
+    QByteArray layouts[] = {full, partial};
+    for (const auto &layout : layouts) {
+        tabWidget.restoreLayout(layout);
+        if (2 != tabWidget.count()
+                || TabWidgetPlus::tabWidgetState::hidden != tabWidget.tabState(pages[1])) {
+            return "filter not applied after restore";
+        }
+        tabWidget.clearFilter();
+        if (3 != tabWidget.count()) {
+            return "clearing the filter left " + QString::number(tabWidget.count())
+                   + " tabs";
+        }
+        tabWidget.setFilter(QRegularExpression("keep"));
+    }
+    return QString();
+}
+
+// A throttled timer gets its interval back when its page is removed
+// and when the throttle goes.
+QString throttleLetsGo()
+{
+    TabWidgetPlus tabWidget;
+    auto page = new QWidget;
+    auto timer = new QTimer(page);
+    timer->start(10);
+    tabWidget.addTab(page, "Ticking");
+    auto throttle = new TabTimerThrottle(&tabWidget);
+    if (10 == timer->interval()) {
+        return "timer not throttled";
+    }
+    tabWidget.removeTab(tabWidget.indexOf(page));
+    if (10 != timer->interval()) {
+        return "timer still throttled after removeTab()";
+    }
+    tabWidget.addTab(page, "Ticking");
+    delete throttle;
+    auto interval = timer->interval();
+    delete page;
+    return 10 == interval ? QString() : "timer still throttled after the throttle went";
+}
+
+// Deleting a tab's page, hidden or not, leaves nothing of it behind:
+// once the first hundred cycles have sized the tables, a thousand more
+// don't grow them.
+QString churnLeavesNothing()
+{
+    TabWidgetPlus tabWidget;
+    for (auto i = 0; i < 10; ++i) {
+        tabWidget.addTab(new QWidget, "Fixed " + QString::number(i));
+    }
+    TabMemoryReport::Overhead warm;
+    for (auto i = 0; i < 1100; ++i) {
+        if (100 == i) {
+            warm = tabWidget.memoryReport().overhead;
+        }
+        auto page = new QWidget;
+        tabWidget.addTab(page, "Churn");
+        if (0 != (i % 2)) {
+            tabWidget.hideTab(page);
+        }
+        delete page;
+    }
+    auto after = tabWidget.memoryReport().overhead;
+    if (10 != after.entries) {
+        return QString::number(after.entries - 10) + " records left behind";
+    }
+    if (warm.registryBytes != after.registryBytes || warm.queueBytes != after.queueBytes) {
+        return "bookkeeping grew by "
+               + QString::number(after.registryBytes + after.queueBytes
+                                 - warm.registryBytes - warm.queueBytes)
+               + " bytes";
+    }
+    return QString();
+}
+
+// A page built without being activated isn't evicted ahead of one
+// that was activated earlier.
+QString builtPageKept()
+{
+    TabWidgetPlus tabWidget;
+    tabWidget.addTab(new QWidget, "Plain");
+    auto factory = []() {
+        return new QWidget;
+    };
+    auto used = qobject_cast<LazyTabPage *>(
+                    tabWidget.widget(tabWidget.addLazyTab(factory, "Used")));
+    auto built = qobject_cast<LazyTabPage *>(
+                     tabWidget.widget(tabWidget.addLazyTab(factory, "Built")));
+    tabWidget.setCurrentWidget(used);
+    tabWidget.setCurrentIndex(0);
+    built->materialize();
+
+    TabWidgetPlus::EvictionPolicy policy;
+    policy.maxLivePages = 1;
+    tabWidget.setEvictionPolicy(policy);
+    if (!built->isMaterialized()) {
+        return "the page built last was evicted";
+    }
+    return used->isMaterialized() ? "nothing was evicted" : QString();
+}
+
+struct Scenario {
+    const char *name;
+    QString (*run)();
+};
+
+const Scenario scenarioList[] = {
+    {"retitle, hide, show before the flush", retitleHideShow},
+    {"restore with a filter set", restoreWhileFiltered},
+    {"throttle lets go of timers", throttleLetsGo},
+    {"churned tabs leave nothing behind", churnLeavesNothing},
+    {"a built page outlives older ones", builtPageKept}
+};
+
+} // namespace
+
+QStringList TabStressDriver::scenarios()
+{
+    QStringList failures;
+    for (const auto &scenario : scenarioList) {
+        auto failure = scenario.run();
+        if (!failure.isEmpty()) {
+            failures << QString(scenario.name) + ": " + failure;
+        }
+    }
+    return failures;
+}
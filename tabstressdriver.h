@@ -0,0 +1,116 @@
+#ifndef TABSTRESSDRIVER_H
+#define TABSTRESSDRIVER_H
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Seeded, headless stress runs for TabWidgetPlus.
+ *
+ * The driver throws a random mix of create, insert, delete, hide, show,
+ * enable/disable, retitle, move (as if dragged) and remove (removeTab()
+ * without deleting the page) requests at a (never shown) TabWidgetPlus,
+ * and after every step compares the tab bar with a plain list of the
+ * tabs it expects, in order, with their visible/enabled flags and
+ * titles.  The same seed always produces the same run.
+ *
+ * When the tab widget and the list disagree, the steps up to that point
+ * are cut down (by delta debugging) to a short trace that still fails,
+ * which can be saved and fed back through replay().
+ */
+class TabStressDriver
+{
+public:
+    enum class Action : unsigned char {
+        Create, Insert, Delete, Hide, Show, Enable, Disable, Retitle, Move,
+        Remove
+    };
+
+    //
+    // One request.  The argument picks the tab (or the insert position)
+    // modulo however many there are when the step runs, so any subset of
+    // a trace is still a valid trace.
+    //
+    struct Step {
+        Action action;
+        quint32 argument;
+    };
+    typedef std::vector<Step> Trace;
+
+    struct Result {
+        quint64 steps = 0;      // steps run, including the failing one
+        qint64 nsecs = 0;
+        QString failure;        // empty if the run passed
+        Trace minimized;        // failing trace, after minimizing
+    };
+
+    /**
+     * @param maxTabs Upper bound on the number of live tabs.  A create
+     * request beyond it deletes a tab instead.
+     */
+    explicit TabStressDriver(int maxTabs = 32);
+    ~TabStressDriver();
+
+    // The first 'steps' steps of the run for 'seed'.
+    static Trace generate(quint32 seed, quint64 steps);
+
+    /**
+     * @brief Run 'steps' random steps from 'seed', checking each one.
+     *
+     * Steps are generated as they run, so long runs take no memory for
+     * the trace.  On failure the trace is regenerated from the seed and
+     * minimized.
+     */
+    Result run(quint32 seed, quint64 steps) const;
+
+    // Run a recorded trace, stopping at the first failing step.
+    Result replay(const Trace &trace) const;
+
+    /**
+     * @brief replay() on a tab widget kept from the previous call.
+     *
+     * The tabs left by the last call are deleted first, so the tab
+     * widget starts out empty as in replay(), but isn't rebuilt each
+     * time.  This is what the fuzzer (fuzz/tabfuzzer.cpp) runs.
+     */
+    Result replayReusing(const Trace &trace);
+
+    // Steps from raw bytes, for fuzzers:  three bytes per step (the
+    // action, then the low and high halves of the argument).  A partial
+    // step at the end is dropped.
+    static Trace decode(const unsigned char *data, std::size_t size);
+
+    // Shrink a failing trace to one where no single chunk can be removed.
+    Trace minimize(const Trace &failing) const;
+
+    // One "action argument" line per step, and back.  parse() skips blank
+    // lines and lines starting with '#'; 'ok' is cleared on bad input.
+    static QString format(const Trace &trace);
+    static Trace parse(const QString &text, bool *ok = nullptr);
+
+    // Plain text summary of a result, including any minimized trace.
+    static QString report(const Result &result);
+
+    /**
+     * @brief Fixed checks for cases the random steps don't reach.
+     *
+     * Each scenario sets up one past bug (with coalesced updates, a
+     * filter, a saved layout...) on a fresh tab widget.
+     *
+     * @return One line per scenario that failed; empty if all passed.
+     */
+    static QStringList scenarios();
+
+private:
+    Q_DISABLE_COPY(TabStressDriver)
+    class StressRun;
+
+    int maxTabs;
+    std::unique_ptr<StressRun> reusedRun;
+};
+
+#endif // TABSTRESSDRIVER_H
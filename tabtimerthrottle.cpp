@@ -0,0 +1,170 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#include "tabtimerthrottle.h"
+#include <QTimer>
+#include <algorithm>
+
+namespace {
+
+// Kept on each throttled timer:  its own interval, and whether we
+// stopped it (rather than its page).
+const char *const baseIntervalProperty = "tabThrottleInterval";
+const char *const stoppedProperty = "tabThrottleStopped";
+
+} // namespace
+
+TabTimerThrottle::TabTimerThrottle(TabWidgetPlus *tabWidget)
+    : QObject(tabWidget), tabWidget(tabWidget)
+{
+    connect(tabWidget, &TabWidgetPlus::activityLevelChanged,
+            this, &TabTimerThrottle::activityLevelChanged);
+    connect(tabWidget, &TabWidgetPlus::tabReleased,
+            this, &TabTimerThrottle::tabReleased);
+    if (tabWidget->activityTracking()) {
+        // Already tracking, so the pages won't be published again.
+        tabWidget->forEachTab([this](const TabWidgetPlus::TabInfo & tab) {
+            activityLevelChanged(tab.widget, this->tabWidget->activityLevel(tab.widget));
+        });
+    } else {
+        tabWidget->setActivityTracking(true);
+    }
+}
+
+TabTimerThrottle::~TabTimerThrottle()
+{
+    //
+    // We may be going as a child of the tab widget, after its registry
+    // is gone, so this works from our own list rather than its tabs.
+    //
+    auto timers = throttled.values();
+    for (const auto &timer : timers) {
+        if (!timer.isNull()) {
+            throttle(timer, 1);
+        }
+    }
+}
+
+void TabTimerThrottle::setPolicy(const Policy &policy)
+{
+    levels = policy;
+    tabWidget->forEachTab([this](const TabWidgetPlus::TabInfo & tab) {
+        activityLevelChanged(tab.widget, tabWidget->activityLevel(tab.widget));
+    });
+}
+
+TabTimerThrottle::Policy TabTimerThrottle::policy() const
+{
+    return levels;
+}
+
+int TabTimerThrottle::throttledTimers() const
+{
+    auto result = 0;
+    for (const auto &timer : throttled) {
+        result += timer.isNull() ? 0 : 1;
+    }
+    return result;
+}
+
+void TabTimerThrottle::activityLevelChanged(QWidget *widget,
+                                            TabWidgetPlus::tabActivityLevel level)
+{
+    auto factor = factorFor(level);
+    for (auto timer : widget->findChildren<QTimer *>()) {
+        throttle(timer, factor);
+    }
+}
+
+void TabTimerThrottle::tabReleased(QWidget *widget)
+{
+    for (auto timer : widget->findChildren<QTimer *>()) {
+        throttle(timer, 1);
+    }
+}
+
+int TabTimerThrottle::factorFor(TabWidgetPlus::tabActivityLevel level) const
+{
+    switch (level) {
+    case TabWidgetPlus::tabActivityLevel::current:
+        break;
+    case TabWidgetPlus::tabActivityLevel::visible:
+        return levels.visibleFactor;
+    case TabWidgetPlus::tabActivityLevel::background:
+        return levels.backgroundFactor;
+    case TabWidgetPlus::tabActivityLevel::hidden:
+        return levels.hiddenFactor;
+    }
+    return 1;
+}
+
+void TabTimerThrottle::throttle(QTimer *timer, int factor)
+{
+    //
+    // Always work from the timer's own interval, so moving between two
+    // throttled levels doesn't compound the factors.
+    //
+    auto base = timer->property(baseIntervalProperty);
+    auto stopped = timer->property(stoppedProperty).toBool();
+    if (!base.isValid()) {
+        if (1 == factor || !timer->isActive()) {
+            // Nothing to slow down; a stopped timer is its page's business.
+            return;
+        }
+        base = timer->interval();
+        timer->setProperty(baseIntervalProperty, base);
+        if (throttled.size() >= sweepAt) {
+            for (auto iter = throttled.begin(); iter != throttled.end();) {
+                if (iter->isNull()) {
+                    iter = throttled.erase(iter);
+                } else {
+                    ++iter;
+                }
+            }
+            sweepAt = std::max<int>(64, 2 * int(throttled.size()));
+        }
+        throttled.insert(timer, timer);
+    }
+
+    if (1 == factor) {
+        timer->setInterval(base.toInt());
+        if (stopped) {
+            timer->start();
+        }
+        timer->setProperty(baseIntervalProperty, QVariant());
+        timer->setProperty(stoppedProperty, QVariant());
+        throttled.remove(timer);
+    } else if (0 == factor) {
+        if (timer->isActive()) {
+            timer->stop();
+            timer->setProperty(stoppedProperty, true);
+        }
+        timer->setInterval(base.toInt());
+    } else {
+        timer->setInterval(base.toInt() * factor);
+        if (stopped) {
+            timer->start();
+            timer->setProperty(stoppedProperty, QVariant());
+        }
+    }
+}
@@ -0,0 +1,93 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#ifndef TABTIMERTHROTTLE_H
+#define TABTIMERTHROTTLE_H
+
+#include "tabwidgetplus.h"
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+
+class QTimer;
+
+/**
+ * @brief Slows down the QTimers of pages that aren't current.
+ *
+ * Follows TabWidgetPlus::activityLevelChanged() (turning activity
+ * tracking on) and stretches or stops the QTimers that are children of
+ * each page, so that a tab widget full of ticking pages costs about as
+ * much as its current page.  A timer's own interval comes back, and a
+ * timer that was stopped is started again, when its page is current,
+ * when the page leaves the tab widget (TabWidgetPlus::tabReleased()),
+ * and when the throttle is deleted.
+ *
+ * Only QTimer objects are touched.  Pages that tick some other way
+ * (QObject::startTimer(), animations) can watch the activity property
+ * on themselves instead.  A page should not change the interval of a
+ * throttled timer itself, since it is reset when the page comes back.
+ */
+class TabTimerThrottle : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TabTimerThrottle(TabWidgetPlus *tabWidget);
+    virtual ~TabTimerThrottle();
+
+    //
+    // How many times slower a page's timers run at each level that
+    // isn't current.  0 stops them.  The defaults slow pages down the
+    // further they are from being seen, but stop nothing, so a page
+    // that polls something still notices changes.
+    //
+    struct Policy {
+        int visibleFactor = 4;
+        int backgroundFactor = 8;
+        int hiddenFactor = 16;
+    };
+    void setPolicy(const Policy &policy);
+    Policy policy() const;
+
+    // Number of timers currently slowed down or stopped.
+    int throttledTimers() const;
+
+private slots:
+    void activityLevelChanged(QWidget *widget, TabWidgetPlus::tabActivityLevel level);
+    void tabReleased(QWidget *widget);
+
+private:
+    void throttle(QTimer *timer, int factor);
+    int factorFor(TabWidgetPlus::tabActivityLevel level) const;
+
+    TabWidgetPlus *tabWidget;
+    Policy levels;
+
+    // Every timer we have slowed down or stopped, so they can all be
+    // put back when we go, even once the tab widget itself is half
+    // destroyed.  Timers deleted while throttled leave a null pointer,
+    // swept out once the hash has doubled.
+    QHash<QTimer *, QPointer<QTimer>> throttled;
+    int sweepAt = 64;
+};
+
+#endif // TABTIMERTHROTTLE_H
@@ -22,18 +22,70 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  **-------------------------------------------------------------------------*/
 #include "tabwidgetplus.h"
+#include "lazytabpage.h"
+#include "tabactivationtracer.h"
+#include "tabcommandqueue.h"
+#include "tabgroup.h"
+#include "tabpreviewcache.h"
+#include "tabsearchpopup.h"
+#include "virtualtabbar.h"
+#include <QDataStream>
 #include <QEvent>
+#include <QHash>
 #include <QLabel>
+#include <QRegularExpression>
+#include <QStackedWidget>
 #include <QTabBar>
 #include <QTimer>
+#include <QToolButton>
+#include <algorithm>
 #include <assert.h>
+#include <vector>
 
-TabWidgetPlus::TabWidgetPlus(QWidget *parent) : QTabWidget(parent)
+//
+// Probes for TabWidgetStats.  Without TABWIDGETPLUS_STATS they expand
+// to nothing, so the hot paths below pay nothing for them.
+//
+#ifdef TABWIDGETPLUS_STATS
+#define TABWIDGETPLUS_TIME(probe) \
+    TabWidgetStats::Timer probeTimer(statsData.probes[TabWidgetStats::probe])
+#define TABWIDGETPLUS_COUNT(statement) statement
+#else
+#define TABWIDGETPLUS_TIME(probe)
+#define TABWIDGETPLUS_COUNT(statement)
+#endif
+
+const char *const TabWidgetPlus::activityProperty = "tabActivityLevel";
+
+TabWidgetPlus::TabWidgetPlus(QWidget *parent)
+    : QTabWidget(parent), commands(new TabCommandQueue(this))
+{
+    connect(this, &QTabWidget::currentChanged,
+            this, &TabWidgetPlus::activateCurrent);
+    connect(tabBar(), &QTabBar::tabMoved, this, &TabWidgetPlus::followTabMove);
+}
+
+TabWidgetPlus::~TabWidgetPlus()
 {
+    //
+    // Our pages are deleted by the QWidget destructor, which runs after
+    // the registry is gone.  Cut the per-widget hooks now so that the
+    // pages dying later don't call back into a half-destroyed object.
+    // This is the only cleanup needed: every hook belongs to an entry.
+    //
+    for (auto entry = registry.first(); nullptr != entry;
+            entry = registry.next(entry)) {
+        untrackWidget(entry);
+    }
+    if (nullptr != tabGroup) {
+        tabGroup->viewList.removeOne(this);
+    }
 }
 
 void TabWidgetPlus::tabInserted(int index)
 {
+    TABWIDGETPLUS_TIME(TabInserted);
+    TABWIDGETPLUS_COUNT(countRelayout());
     QTabWidget::tabInserted(index);
     auto newWidget = widget(index);
     if (nullptr == newWidget) {
@@ -42,109 +94,161 @@ void TabWidgetPlus::tabInserted(int index)
     }
 
     // Set the enabled flag in the tab header based on
-    // whether or not the widget itself is enabled.
+    // whether or not the widget itself is enabled.  The tooltip
+    // follows the widget's tooltip the same way.
     tabBar()->setTabEnabled(index, newWidget->isEnabled());
+    if (!newWidget->toolTip().isEmpty()) {
+        tabBar()->setTabToolTip(index, newWidget->toolTip());
+    }
 
-    auto objectNotSeenBefore = true;
-
-    //
-    // This class tracks indexes on hidden tabs.  When a new tab
-    // has been inserted, then we have to adjust the hidden indexes
-    // for tabs that would come *after* the newly inserted tab.
-    //
-    // There are two possibilities for what *after* means:
-    // 1)  For a new (previously unknown) tab, "after" means
-    //     any index higher than the one that was just inserted.
-    // 2)  For a tab that was hidden and has now been shown, "after"
-    //     means everything listed after that tab (note that hidden
-    //     tabs can have duplicate indexes).  In this case, we
-    //     also need to remove the hidden tab entry because it's
-    //     not hidden any more.
-    //
-    // Find where we should start incrementing tabs in the hidden list...
-    auto incrementorIter = hidden.end();
-    for (auto iter = hidden.begin(); iter != hidden.end(); ++iter) {
-        if (iter->widget == newWidget) {
-            // This hidden tab is now shown (thus it's not hidden any more)
-            // Remove this item and start incrementing at next item.
-            incrementorIter = hidden.erase(iter);
-            objectNotSeenBefore = false;
-            break;
-        } else if (iter->index > index ) {
-            // Start incrementing with this item.
-            incrementorIter = iter;
-            break;
+    //
+    // This class tracks every tab, hidden or not, in a single ordered
+    // registry.  A hidden tab's index is the number of visible tabs in
+    // front of it, so nothing needs to be renumbered when a tab is
+    // inserted.  All that's left is to record the new tab:
+    //
+    // 1)  For a new (previously unknown) tab, the entry goes in front
+    //     of the visible tab that now follows it.  Hidden tabs that
+    //     were sitting just before that tab stay in front of the new
+    //     one, which matches how indexes were assigned before.
+    // 2)  For a tab that was hidden and has now been shown, the entry
+    //     is already in the right place and just becomes visible.
+    //     (If someone inserted it somewhere else, move it there.)
+    //
+    auto entry = registry.find(newWidget);
+    auto following = registry.find(widget(index + 1));
+    if (nullptr == entry) {
+        // Never seen before, so add hooks that let us follow changes
+        // to the object and update the related tab entry.
+        auto newEntry = registry.insert(newWidget, following, nextTabId());
+        trackWidget(newEntry);
+        publishActivity(newEntry);
+        if (filter) {
+            queueRefilter(newWidget);
+        }
+    } else {
+        if (!entry->hidden || registry.visibleIndex(entry) != index) {
+            registry.move(entry, following);
         }
+        registry.setHidden(entry, false);
+        entry->filteredOut = false;
+        publishActivity(entry);
     }
-    // ... and increment them.
-    while (incrementorIter != hidden.end()) {
-        ++(incrementorIter->index);
-        ++incrementorIter;
-    }
-
-    // If this object has never been seen before, then we want
-    // to add hooks so we can detect changes to the object and change
-    // the related tab entry.
-    if (objectNotSeenBefore) {
-        // Set ourselves up to receive events sent to the new object.
-        // This helps us to find things like enabled/disabled changes.
-        newWidget->installEventFilter(this);
-
-        QList<QMetaObject::Connection> connections;
-
-        // When the new object is destroyed, call tabDestroyed()
-        // on this object so we can get rid of any references to it.
-        connections.push_back(connect(newWidget, &QObject::destroyed, this,
-        [ = ](QObject *) {
-            this->removeHiddenTabData(newWidget);
-        }));
-
-        // When the window title on the new object changes, call
-        // updateTabText() so we can change the tab text.
-        connections.push_back(connect(newWidget, &QWidget::windowTitleChanged, this,
-        [ = ](const QString &) {
-            this->updateTabText(newWidget);
-        }));
-
-        // If this object is destroyed, remove the connections
-        // made above so that the callbacks will not happen
-        // (since this object is no longer valid).
-        connect(this, &QObject::destroyed, this, [ = ](QObject *) {
-            for (const auto &connection : connections) {
-                this->disconnect(connection);
-            }
-        });
+}
+
+void TabWidgetPlus::trackWidget(TabRegistry::Entry *entry)
+{
+    auto newWidget = entry->widget;
+    if (nullptr != tabGroup) {
+        // One set of hooks per widget, however many views there are.
+        tabGroup->track(newWidget, this);
+        return;
+    }
+
+    // Set ourselves up to receive events sent to the new object.
+    // This helps us to find things like enabled/disabled changes.
+    newWidget->installEventFilter(this);
+
+    // When the new object is destroyed, call removeHiddenTabData()
+    // on this object so we can get rid of any references to it.
+    entry->destroyedConnection = connect(newWidget, &QObject::destroyed, this,
+    [ = ](QObject *) {
+        this->removeHiddenTabData(newWidget);
+    });
+
+    // When the window title on the new object changes, call
+    // updateTabText() so we can change the tab text.
+    entry->titleConnection = connect(newWidget, &QWidget::windowTitleChanged, this,
+    [ = ](const QString &) {
+        this->updateTabText(newWidget);
+    });
+}
+
+void TabWidgetPlus::untrackWidget(TabRegistry::Entry *entry)
+{
+    if (nullptr != tabGroup) {
+        tabGroup->untrack(entry->widget, entry->widgetDestroyed);
+        return;
+    }
+    // Once the widget has been destroyed Qt has already dropped its
+    // connections, and there's no event filter left to remove.
+    if (!entry->widgetDestroyed) {
+        entry->widget->removeEventFilter(this);
+        disconnect(entry->destroyedConnection);
+        disconnect(entry->titleConnection);
+    }
+}
+
+void TabWidgetPlus::forgetTab(TabRegistry::Entry *entry)
+{
+    if (nullptr != previewCache) {
+        previewCache->invalidate(entry->widget);
+    }
+    untrackWidget(entry);
+    auto widget = entry->widget;
+    auto released = !entry->widgetDestroyed;
+    registry.erase(entry);
+    if (released) {
+        announceRelease(widget);
     }
 }
 
 void TabWidgetPlus::tabRemoved(int index)
 {
+    TABWIDGETPLUS_TIME(TabRemoved);
+    TABWIDGETPLUS_COUNT(countRelayout());
     //
-    // The indexes in hidden need to be decremented for any tab
-    // following the one that was just removed, so that things
-    // are still in sync.
+    // The registry still lists the removed tab at this index.  If
+    // hideTab() is the one removing it, keep the entry as a hidden
+    // tab; otherwise forget about it.  Either way, tabs following
+    // it pick up their new indexes automatically.
     //
     QTabWidget::tabRemoved(index);
-    for (auto iter = hidden.begin(); iter != hidden.end(); ++iter) {
-        if (iter->index > index) {
-            --(iter->index);
-        }
+    auto entry = registry.visibleAt(index);
+    if (nullptr == entry) {
+        return;
+    }
+    if (entry->widget == pendingHide) {
+        registry.setHidden(entry, true);
+        publishActivity(entry);
+    } else {
+        forgetTab(entry);
+    }
+}
+
+void TabWidgetPlus::followTabMove(int from, int to)
+{
+    //
+    // The user dragged a tab (or someone called QTabBar::moveTab()),
+    // which QTabWidget handles without tabInserted()/tabRemoved().  The
+    // registry still has the old order, so 'from' finds the tab, and
+    // it goes in front of the tab that follows 'to' once it is out of
+    // the way.  Hidden tabs stay next to the tabs they were beside,
+    // and none of them is touched.
+    //
+    auto entry = registry.visibleAt(from);
+    if (nullptr == entry || from == to) {
+        return;
     }
+    auto following = registry.visibleAt(to < from ? to : to + 1);
+    registry.move(entry, following);
 }
 
 void TabWidgetPlus::removeHiddenTabData(QWidget *widget)
 {
     //
     // An object has been deleted.  If it's visible, then the
-    // underlying base class takes care of everything.  If it was
-    // hidden, though, we need to find the pointer to the widget
-    // and remove it.
+    // underlying base class takes care of everything (and calls
+    // tabRemoved() for us, which drops the entry).  If it was hidden,
+    // though, we need to drop its entry ourselves.
     //
-    for (auto iter = hidden.begin(); iter != hidden.end(); ++iter) {
-        if (iter->widget == widget) {
-            hidden.erase(iter);
-            return;
-        }
+    auto entry = registry.find(widget);
+    if (nullptr == entry) {
+        return;
+    }
+    entry->widgetDestroyed = true;
+    if (entry->hidden) {
+        forgetTab(entry);
     }
 }
 
@@ -155,89 +259,1374 @@ void TabWidgetPlus::updateTabText(QWidget *widget)
     // the window title as a way to update the tab text for the
     // widget's related tab, we need to also update the tab text.
     //
+    if (filter) {
+        queueRefilter(widget);
+    }
+    if (nullptr != flushTimer) {
+        markDirty(widget, DirtyText);
+        return;
+    }
     auto index = indexOf(widget);
     if (-1 < index) {
         auto newText = widget->windowTitle();
         tabBar()->setTabText(index, newText);
+        TABWIDGETPLUS_COUNT(countRelayout());
     }
 }
 
 void TabWidgetPlus::hideTab(QWidget *widget)
 {
+    TABWIDGETPLUS_TIME(HideTab);
     auto index = indexOf(widget);
     if (-1 == index) {
+        // Already out of the tab bar; if the filter put it there, it
+        // now stays hidden when the filter lets it back in.
+        auto entry = registry.find(widget);
+        if (nullptr != entry) {
+            entry->filteredOut = false;
+        }
         return;
     }
+    hideTabAt(index, widget);
+}
 
+void TabWidgetPlus::hideTabAt(int index, QWidget *widget)
+{
     // By design, this uses the 'window title' of the object
     // to retain a copy of the tab text.  When/If the object
-    // is re-shown the title can then be restored.
-    auto currentTitle = tabBar()->tabText(index);
+    // is re-shown the title can then be restored.  tabTitle() rather
+    // than the tab text, which lags behind a coalesced retitle.
+    auto currentTitle = tabTitle(registry.find(widget));
     widget->setWindowTitle(currentTitle);
 
-    // Now, add the widget to the hidden list.  Since the indexes
-    // will be adjusted down once the actual removal is done,
-    // the index on the insertion needs to be one higher than
-    // the final position.
-    auto insertLocation = hidden.end();
-    for (auto iter = hidden.begin(); iter != hidden.end(); ++iter) {
-        if (iter->index > index) {
-            insertLocation = iter;
-            break;
-        }
+    // grab() renders the whole page right here, which a bulk hide
+    // (hideTabs(), the filter, restoreLayout()) can't afford per tab.
+    if (nullptr != previewCache && 0 == batchDepth) {
+        previewCache->capture(widget);
     }
-    HiddenTab hiddenItem;
-    hiddenItem.index = 1 + index;
-    hiddenItem.widget = widget;
-    hidden.insert(insertLocation, std::move(hiddenItem));
+
+    // Now remove the tab.  tabRemoved() keeps the widget's entry
+    // where it is and marks it hidden, so it can later be shown in
+    // the same place.
+    pendingHide = widget;
     removeTab(index);
+    pendingHide = nullptr;
+
+    if (eviction.evictHidden) {
+        auto lazyPage = qobject_cast<LazyTabPage *>(widget);
+        if (nullptr != lazyPage) {
+            lazyPage->evict();
+        }
+    }
 }
 
 
 void TabWidgetPlus::showTab(QWidget *widget)
 {
-    for (auto iter = hidden.begin(); iter != hidden.end(); ++iter) {
-        if (iter->widget == widget) {
-            // Note that I CANNOT remove the item from the
-            // hidden list here:  I have to know where the
-            // hidden item came from after it shows up in order
-            // to adjust the hidden indexes correctly.
-            // (one use case: think of showing a hidden item between
-            // two other hidden items.)
-            insertTab(iter->index, iter->widget, widget->windowTitle());
-            break;
+    TABWIDGETPLUS_TIME(ShowTab);
+    auto entry = registry.find(widget);
+    if (nullptr != entry && entry->hidden) {
+        if (nullptr != tracer) {
+            tracer->beginShow(widget);
+        }
+        // Note that the entry stays hidden until tabInserted() sees
+        // the widget arrive, so that both paths agree on where it is.
+        insertTab(registry.visibleIndex(entry), widget, widget->windowTitle());
+        if (nullptr != tracer) {
+            tracer->showDone(tabBar()->isVisible());
         }
     }
 }
 
-bool TabWidgetPlus::eventFilter(QObject *obj, QEvent *event)
+void TabWidgetPlus::hideTabs(const QList<QWidget *> &widgets)
 {
-    if (QEvent::EnabledChange == event->type()) {
-        //
-        // Since we installed the event filter for a QWidget, we
-        // *absolutely know* the object provided is a QWidget.
-        //
-        auto widget = reinterpret_cast<QWidget *>(obj);
-        auto index = indexOf(widget);
-        if (-1 != index) {
-            tabBar()->setTabEnabled(index, widget->isEnabled());
+    //
+    // Look every index up once, then remove from the highest index
+    // down so that each removal leaves the remaining indexes alone.
+    //
+    std::vector<std::pair<int, QWidget *>> targets;
+    targets.reserve(widgets.size());
+    for (auto widget : widgets) {
+        auto entry = registry.find(widget);
+        if (nullptr != entry && !entry->hidden) {
+            targets.emplace_back(registry.visibleIndex(entry), widget);
         }
     }
-    return false;
+    std::sort(targets.begin(), targets.end());
+    targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+
+    BatchScope batch(this);
+    for (auto iter = targets.rbegin(); iter != targets.rend(); ++iter) {
+        hideTabAt(iter->first, iter->second);
+    }
 }
 
-TabWidgetPlus::tabWidgetState TabWidgetPlus::tabState( QWidget *widget) const
+void TabWidgetPlus::showTabs(const QList<QWidget *> &widgets)
 {
-    auto result = tabWidgetState::unknown;
-    if (-1 != indexOf(widget)) {
-        result = tabWidgetState::visible;
-    } else {
-        for (auto &item : hidden) {
-            if (item.widget == widget) {
-                result = tabWidgetState::hidden;
-                break;
-            }
+    //
+    // Each hidden entry already knows where it belongs relative to
+    // every other tab, so the order we show them in doesn't matter:
+    // showTab() reads the index at the moment of insertion.
+    //
+    BatchScope batch(this);
+    for (auto widget : widgets) {
+        showTab(widget);
+    }
+}
+
+TabWidgetPlus::BatchScope::BatchScope(TabWidgetPlus *tabWidget)
+    : tabWidget(tabWidget)
+{
+    tabWidget->beginBatch();
+}
+
+TabWidgetPlus::BatchScope::~BatchScope()
+{
+    tabWidget->endBatch();
+}
+
+void TabWidgetPlus::beginBatch()
+{
+    if (0 != batchDepth++) {
+        return;
+    }
+    batchCurrent = currentWidget();
+    batchSignalsBlocked = blockSignals(true);
+
+    //
+    // Only the tab bar stops painting.  setUpdatesEnabled() recurses,
+    // so turning it off on us or on the stacked widget would reach
+    // into every page; the stack paints its new current page once
+    // anyway, since paints wait for the event loop.
+    //
+    batchTabBarUpdates = tabBar()->updatesEnabled();
+    tabBar()->setUpdatesEnabled(false);
+
+    //
+    // QTabBar lays itself out on every insert and remove, but only
+    // while it is visible.  Hiding it for the batch (which nobody sees,
+    // since it doesn't paint) leaves a single layout for the end.  The
+    // cost is small and bounded:  the hide and show each post us a
+    // LayoutRequest, which Qt merges into one setUpLayout() after the
+    // batch (the same work one addTab() does), and only the tab bar
+    // gets hide and show events.  Hiding moves focus only if the tab
+    // bar has it, so then we don't hide it.  With tabBarAutoHide() the
+    // tab bar shows and hides itself on every insert and remove, which
+    // would undo the trick, so it is skipped then too.
+    //
+    batchTabBarVisible = tabBar()->isVisible() && !tabBar()->hasFocus()
+                         && !tabBarAutoHide();
+    if (batchTabBarVisible) {
+        tabBar()->hide();
+    }
+}
+
+void TabWidgetPlus::endBatch()
+{
+    if (0 != --batchDepth) {
+        return;
+    }
+    if (batchTabBarVisible) {
+        // In case auto-hide was turned on during the batch.
+        tabBar()->setVisible(!tabBarAutoHide() || 1 < count());
+    }
+    blockSignals(batchSignalsBlocked);
+    tabBar()->setUpdatesEnabled(batchTabBarUpdates);
+
+    if (currentWidget() != batchCurrent.data()) {
+        emit currentChanged(currentIndex());
+    }
+    batchCurrent.clear();
+
+    // Widgets deleted during the batch no longer have an entry.
+    std::vector<QWidget *> widgets;
+    widgets.swap(batchActivity);
+    for (auto widget : widgets) {
+        auto entry = registry.find(widget);
+        if (nullptr != entry) {
+            publishActivity(entry);
+        }
+    }
+    std::vector<QPointer<QWidget>> released;
+    released.swap(batchReleased);
+    for (const auto &widget : released) {
+        if (!widget.isNull() && nullptr == registry.find(widget)) {
+            emit tabReleased(widget);
+        }
+    }
+}
+
+void TabWidgetPlus::setFilter(std::function<bool(QWidget *)> accepts)
+{
+    filter = std::move(accepts);
+    refilterAll();
+}
+
+void TabWidgetPlus::refilterAll()
+{
+    filterQueue.clear();
+
+    // One pass over every tab, in display order.
+    std::vector<QWidget *> widgets;
+    widgets.reserve(registry.size());
+    for (auto entry = registry.first(); nullptr != entry;
+            entry = registry.next(entry)) {
+        widgets.push_back(entry->widget);
+    }
+    refilter(widgets);
+}
+
+void TabWidgetPlus::setFilter(const QRegularExpression &titlePattern)
+{
+    setFilter([this, titlePattern](QWidget * widget) {
+        return titlePattern.match(tabTitle(registry.find(widget))).hasMatch();
+    });
+}
+
+void TabWidgetPlus::clearFilter()
+{
+    setFilter(std::function<bool(QWidget *)>());
+}
+
+bool TabWidgetPlus::isFiltered() const
+{
+    return static_cast<bool>(filter);
+}
+
+void TabWidgetPlus::refilter(const std::vector<QWidget *> &widgets)
+{
+    //
+    // Each tab's state is read as it is reached, so a widget listed
+    // twice (or already in the right state) costs only the check.
+    // Tabs the user hid stay hidden whatever the filter says.
+    //
+    BatchScope batch(this);
+    for (auto widget : widgets) {
+        auto entry = registry.find(widget);
+        if (nullptr == entry || (entry->hidden && !entry->filteredOut)) {
+            continue;
+        }
+        auto accepted = !filter || filter(widget);
+        if (accepted && entry->hidden) {
+            showTab(widget);
+        } else if (!accepted && !entry->hidden) {
+            hideTabAt(indexOf(widget), widget);
+            entry->filteredOut = true;
+        }
+    }
+}
+
+void TabWidgetPlus::queueRefilter(QWidget *widget)
+{
+    if (nullptr == filterTimer) {
+        filterTimer = new QTimer(this);
+        filterTimer->setSingleShot(true);
+        filterTimer->setInterval(0);
+        connect(filterTimer, &QTimer::timeout, this, &TabWidgetPlus::flushFilterQueue);
+    }
+    filterQueue.push_back(widget);
+    if (!filterTimer->isActive()) {
+        filterTimer->start();
+    }
+}
+
+void TabWidgetPlus::flushFilterQueue()
+{
+    // Deleted widgets have no entry any more, and refilter() skips them.
+    std::vector<QWidget *> widgets;
+    widgets.swap(filterQueue);
+    if (filter) {
+        refilter(widgets);
+    }
+}
+
+QString TabWidgetPlus::tabTitle(const TabRegistry::Entry *entry) const
+{
+    //
+    // A hidden tab keeps its text in the window title (see hideTabAt()),
+    // and so does a visible one whose new title hasn't been flushed to
+    // the tab bar yet.  Otherwise the tab bar has it.
+    //
+    if (nullptr == entry) {
+        return QString();
+    }
+    if (entry->hidden || 0 != (entry->dirty & DirtyText)) {
+        return entry->widget->windowTitle();
+    }
+    return tabBar()->tabText(registry.visibleIndex(entry));
+}
+
+namespace {
+
+// saveLayout() format:  magic, version, the index of the current tab
+// in the list (or -1), then every tab in display order.
+const quint32 layoutMagic = 0x54575031; // "TWP1"
+const quint16 layoutVersion = 1;
+
+struct SavedTab {
+    QString name;
+    QString title;
+    bool hidden = false;
+    bool enabled = true;
+};
+
+} // namespace
+
+QByteArray TabWidgetPlus::saveLayout() const
+{
+    QByteArray result;
+    QDataStream stream(&result, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    auto current = currentWidget();
+    qint32 currentTab = -1;
+    qint32 position = 0;
+    for (auto entry = registry.first(); nullptr != entry;
+            entry = registry.next(entry), ++position) {
+        if (entry->widget == current) {
+            currentTab = position;
         }
     }
+    stream << layoutMagic << layoutVersion << currentTab
+           << static_cast<quint32>(registry.size());
+
+    for (auto entry = registry.first(); nullptr != entry;
+            entry = registry.next(entry)) {
+        // The filter is a passing view, so tabs it hides are saved as
+        // visible.
+        auto widget = entry->widget;
+        auto hidden = entry->hidden && !entry->filteredOut;
+        stream << widget->objectName() << tabTitle(entry) << hidden
+               << widget->isEnabled();
+    }
     return result;
 }
+
+bool TabWidgetPlus::restoreLayout(const QByteArray &layout,
+                                  std::function<QWidget *(const QString &)> resolve)
+{
+    //
+    // Read everything first, so that bad data changes nothing.
+    //
+    QDataStream stream(layout);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint32 currentTab = -1;
+    quint32 tabCount = 0;
+    stream >> magic >> version >> currentTab >> tabCount;
+    if (layoutMagic != magic || layoutVersion != version
+            || QDataStream::Ok != stream.status()) {
+        return false;
+    }
+    std::vector<SavedTab> saved;
+    for (quint32 i = 0; i < tabCount && QDataStream::Ok == stream.status(); ++i) {
+        SavedTab tab;
+        stream >> tab.name >> tab.title >> tab.hidden >> tab.enabled;
+        saved.push_back(tab);
+    }
+    if (QDataStream::Ok != stream.status()) {
+        return false;
+    }
+
+    BatchScope batch(this);
+
+    //
+    // Take every visible tab out of the tab bar, remembering what it
+    // looked like.  Their entries stay (as hidden), so every tab keeps
+    // its ID and hooks.  Removing from the end keeps QTabBar from
+    // shifting the tabs that are left.
+    //
+    struct KnownTab {
+        QWidget *widget;
+        QString title;
+        QIcon icon;
+        bool hidden;
+        bool filteredOut;
+    };
+    std::vector<KnownTab> known;
+    known.reserve(registry.size());
+    for (auto entry = registry.first(); nullptr != entry;
+            entry = registry.next(entry)) {
+        KnownTab tab;
+        tab.widget = entry->widget;
+        tab.hidden = entry->hidden;
+        tab.filteredOut = entry->filteredOut;
+        tab.title = tabTitle(entry);
+        if (!tab.hidden) {
+            tab.icon = tabIcon(registry.visibleIndex(entry));
+        }
+        known.push_back(tab);
+    }
+    for (auto index = count() - 1; index >= 0; --index) {
+        pendingHide = widget(index);
+        removeTab(index);
+    }
+    pendingHide = nullptr;
+
+    // Widgets by name, in display order, so duplicate names pair up
+    // in the order they were saved.
+    QHash<QString, QList<std::size_t>> byName;
+    for (std::size_t i = 0; i < known.size(); ++i) {
+        byName[known[i].widget->objectName()].append(i);
+    }
+    std::vector<bool> used(known.size(), false);
+
+    //
+    // Put each tab at the end, in saved order, so the registry never
+    // has to look anything up to place it.  'hidden' means hidden by
+    // the user; the filter gets its say once everything is placed.
+    //
+    auto place = [this](QWidget * widget, bool hidden, const QString & title,
+    const QIcon & icon) {
+        auto entry = registry.find(widget);
+        if (nullptr == entry) {
+            if (hidden) {
+                addHiddenTab(widget, title);
+            } else {
+                addTab(widget, icon, title);
+            }
+            return;
+        }
+        registry.move(entry, nullptr);
+        entry->filteredOut = false;
+        if (hidden) {
+            widget->setWindowTitle(title);
+        } else {
+            addTab(widget, icon, title);
+        }
+    };
+    QWidget *current = nullptr;
+    for (std::size_t i = 0; i < saved.size(); ++i) {
+        const auto &tab = saved[i];
+        QWidget *widget = nullptr;
+        QIcon icon;
+        auto candidates = byName.find(tab.name);
+        if (candidates != byName.end() && !candidates->isEmpty()) {
+            auto which = candidates->takeFirst();
+            used[which] = true;
+            widget = known[which].widget;
+            icon = known[which].icon;
+        } else if (resolve) {
+            widget = resolve(tab.name);
+            if (nullptr != widget && nullptr != registry.find(widget)) {
+                // Already ours under another name; it keeps its place
+                // with the tabs that aren't in the layout.
+                continue;
+            }
+        }
+        if (nullptr == widget) {
+            continue;
+        }
+        widget->setEnabled(tab.enabled);
+        place(widget, tab.hidden, tab.title, icon);
+        if (static_cast<qint32>(i) == currentTab) {
+            current = widget;
+        }
+    }
+    for (std::size_t i = 0; i < known.size(); ++i) {
+        if (!used[i]) {
+            const auto &tab = known[i];
+            place(tab.widget, tab.hidden && !tab.filteredOut, tab.title, tab.icon);
+        }
+    }
+    if (filter) {
+        refilterAll();
+    }
+
+    if (nullptr != current && !registry.find(current)->hidden) {
+        setCurrentWidget(current);
+    }
+    return true;
+}
+
+void TabWidgetPlus::addHiddenTab(QWidget *widget, const QString &title)
+{
+    //
+    // Same end state as addTab() then hideTab(), without the tab ever
+    // entering (and leaving) the tab bar:  the page is owned by the
+    // stacked widget, out of sight, and its entry is hidden at the end.
+    //
+    auto entry = registry.insert(widget, nullptr, nextTabId());
+    trackWidget(entry);
+    registry.setHidden(entry, true);
+    parkHiddenPage(widget, title);
+}
+
+void TabWidgetPlus::parkHiddenPage(QWidget *widget, const QString &title)
+{
+    // Where hideTab() leaves a page:  in our stack, out of sight, with
+    // the tab text in its window title.
+    auto stack = findChild<QStackedWidget *>(QStringLiteral("qt_tabwidget_stackedwidget"),
+                                             Qt::FindDirectChildrenOnly);
+    if (widget->parentWidget() != stack) {
+        widget->setParent(stack);
+    }
+    widget->hide();
+    widget->setWindowTitle(title);
+}
+
+int TabWidgetPlus::addLazyTab(std::function<QWidget *()> factory,
+                              const QString &title, const QIcon &icon)
+{
+    return insertLazyTab(-1, std::move(factory), title, icon);
+}
+
+int TabWidgetPlus::insertLazyTab(int index, std::function<QWidget *()> factory,
+                                 const QString &title, const QIcon &icon)
+{
+    auto placeholder = new LazyTabPage(std::move(factory));
+    placeholder->setWindowTitle(title);
+    watchLazyPage(placeholder);
+    return insertTab(index, placeholder, icon, title);
+}
+
+int TabWidgetPlus::addAsyncTab(LazyTabPage::Preparer prepare, LazyTabPage::Builder build,
+                               const QString &title, const QIcon &icon)
+{
+    return insertAsyncTab(-1, std::move(prepare), std::move(build), title, icon);
+}
+
+int TabWidgetPlus::insertAsyncTab(int index, LazyTabPage::Preparer prepare,
+                                  LazyTabPage::Builder build, const QString &title,
+                                  const QIcon &icon)
+{
+    auto placeholder = new LazyTabPage(std::move(prepare), std::move(build));
+    placeholder->setWindowTitle(title);
+    watchLazyPage(placeholder);
+    return insertTab(index, placeholder, icon, title);
+}
+
+void TabWidgetPlus::buildNextPage()
+{
+    //
+    // Build the most wanted ready page:  the current tab, else the
+    // first visible one, else the first hidden one.  The tab's widget
+    // stays the same LazyTabPage, so the registry needs nothing;
+    // only the tab's state changes.
+    //
+    readyPages.erase(std::remove_if(readyPages.begin(), readyPages.end(),
+    [this](const QPointer<LazyTabPage> &page) {
+        return page.isNull() || page->isMaterialized()
+               || nullptr == registry.find(page.data());
+    }), readyPages.end());
+
+    auto current = currentWidget();
+    auto best = readyPages.end();
+    auto bestRank = 3;
+    for (auto iter = readyPages.begin(); iter != readyPages.end() && 0 != bestRank; ++iter) {
+        auto rank = iter->data() == current ? 0 : registry.find(iter->data())->hidden ? 2 : 1;
+        if (rank < bestRank) {
+            best = iter;
+            bestRank = rank;
+        }
+    }
+    if (best == readyPages.end()) {
+        return;
+    }
+    QPointer<LazyTabPage> page = *best;
+    readyPages.erase(best);
+    if (2 != bestRank || !eviction.evictHidden) {
+        // A hidden page that would be evicted right away is left to be
+        // built when it is next current.
+        page->materialize();
+        enforceEvictionPolicy();
+    }
+    if (!readyPages.empty()) {
+        buildTimer->start();
+    }
+}
+
+void TabWidgetPlus::watchLazyPage(LazyTabPage *page)
+{
+    //
+    // Built pages are what the eviction policy keeps count of.  A page
+    // counts as used when it is built, so one built in the background
+    // (never activated, stamp 0) isn't the first to go.
+    //
+    connect(page, &LazyTabPage::materialized, this, [ = ](QWidget *) {
+        ++lazyPageChanges;
+        page->setLastActivated(++activationCount);
+        auto known = std::find(livePages.begin(), livePages.end(), page);
+        if (known == livePages.end()) {
+            livePages.push_back(page);
+        }
+    });
+    connect(page, &LazyTabPage::evicted, this, [ = ]() {
+        ++lazyPageChanges;
+    });
+    if (page->isMaterialized()) {
+        page->setLastActivated(++activationCount);
+        livePages.push_back(page);
+    }
+    if (!page->isReady()) {
+        connect(page, &LazyTabPage::ready, this, [ = ]() {
+            queueBuild(page);
+        });
+    }
+}
+
+void TabWidgetPlus::queueBuild(LazyTabPage *page)
+{
+    if (nullptr == buildTimer) {
+        buildTimer = new QTimer(this);
+        buildTimer->setSingleShot(true);
+        buildTimer->setInterval(0);
+        connect(buildTimer, &QTimer::timeout, this, &TabWidgetPlus::buildNextPage);
+    }
+    readyPages.push_back(page);
+    if (!buildTimer->isActive()) {
+        buildTimer->start();
+    }
+}
+
+void TabWidgetPlus::activateCurrent()
+{
+    // The page that was current just went to the background, looking
+    // the way it will until it is current again.
+    auto current = currentWidget();
+    if (nullptr != tracer) {
+        tracer->beginActivation(current);
+    }
+    auto previousEntry = registry.find(previousCurrent);
+    if (nullptr != previewCache && nullptr != previousEntry && previousCurrent != current) {
+        previewCache->capture(previousCurrent);
+    }
+    previousCurrent = current;
+    if (nullptr != previousEntry) {
+        publishActivity(previousEntry);
+    }
+    auto currentEntry = registry.find(current);
+    if (nullptr != currentEntry) {
+        publishActivity(currentEntry);
+    }
+
+    auto lazyPage = qobject_cast<LazyTabPage *>(current);
+    if (nullptr != lazyPage) {
+        lazyPage->setLastActivated(++activationCount);
+        if (!lazyPage->isMaterialized()) {
+            lazyPage->materialize();
+            enforceEvictionPolicy();
+        }
+    }
+    if (nullptr != tracer) {
+        tracer->activationBookkeepingDone();
+    }
+}
+
+void TabWidgetPlus::setEvictionPolicy(const EvictionPolicy &policy)
+{
+    eviction = policy;
+    enforceEvictionPolicy();
+}
+
+TabWidgetPlus::EvictionPolicy TabWidgetPlus::evictionPolicy() const
+{
+    return eviction;
+}
+
+void TabWidgetPlus::enforceEvictionPolicy()
+{
+    //
+    // Forget pages that were evicted or deleted since the last pass.
+    //
+    livePages.erase(std::remove_if(livePages.begin(), livePages.end(),
+    [](const QPointer<LazyTabPage> &page) {
+        return page.isNull() || !page->isMaterialized();
+    }), livePages.end());
+
+    if (0 == eviction.maxLivePages && 0 == eviction.maxBytes) {
+        return;
+    }
+
+    auto estimate = [this](LazyTabPage * page) -> qint64 {
+        if (eviction.estimateBytes) {
+            return eviction.estimateBytes(page->page());
+        }
+        // Rough guess:  a backing-store sized buffer for the page, plus
+        // a fixed cost for every object in its widget tree.
+        auto realPage = page->page();
+        return qint64(realPage->width()) * realPage->height() * 4
+               + qint64(realPage->findChildren<QObject *>().size() + 1) * 1024;
+    };
+
+    // Oldest activation first, so the front is what goes first.
+    std::sort(livePages.begin(), livePages.end(),
+    [](const QPointer<LazyTabPage> &a, const QPointer<LazyTabPage> &b) {
+        return a->lastActivated() < b->lastActivated();
+    });
+    qint64 totalBytes = 0;
+    if (0 != eviction.maxBytes) {
+        for (const auto &page : livePages) {
+            totalBytes += estimate(page.data());
+        }
+    }
+
+    auto current = currentWidget();
+    auto liveCount = static_cast<int>(livePages.size());
+    for (auto &page : livePages) {
+        auto overCount = 0 != eviction.maxLivePages && liveCount > eviction.maxLivePages;
+        auto overBytes = 0 != eviction.maxBytes && totalBytes > eviction.maxBytes;
+        if (!overCount && !overBytes) {
+            break;
+        }
+        if (page.data() == current) {
+            continue;
+        }
+        if (overBytes) {
+            totalBytes -= estimate(page.data());
+        }
+        page->evict();
+        --liveCount;
+    }
+    livePages.erase(std::remove_if(livePages.begin(), livePages.end(),
+    [](const QPointer<LazyTabPage> &page) {
+        return page.isNull() || !page->isMaterialized();
+    }), livePages.end());
+}
+
+bool TabWidgetPlus::eventFilter(QObject *obj, QEvent *event)
+{
+    //
+    // Every event a page gets (timers, mouse moves, paints...) comes
+    // through here.  Turn away the ones we don't act on first, before
+    // the stats timer or any lookup; paint events only matter while
+    // tracing or keeping previews.
+    //
+    auto type = event->type();
+    if (!isTrackedEvent(type)
+            || (QEvent::Paint == type && nullptr == tracer && nullptr == previewCache)) {
+        return false;
+    }
+    TABWIDGETPLUS_TIME(EventFilter);
+    if (QEvent::Paint == type && nullptr != tracer) {
+        if (obj == tabBar()) {
+            tracer->tabBarPainted();
+            return false;
+        }
+        tracer->pagePainted(static_cast<QWidget *>(obj));
+    }
+    if (QEvent::Paint == type && nullptr != previewCache
+            && !previewCache->isCapturing()) {
+        // The page changed, so its preview is out of date.
+        previewCache->invalidate(static_cast<QWidget *>(obj));
+        return false;
+    }
+    if (QEvent::EnabledChange == type || QEvent::ToolTipChange == type) {
+        //
+        // Since we installed the event filter for a QWidget, we
+        // *absolutely know* the object provided is a QWidget.
+        //
+        auto widget = reinterpret_cast<QWidget *>(obj);
+        auto isEnabledChange = QEvent::EnabledChange == type;
+        if (nullptr != flushTimer) {
+            markDirty(widget, isEnabledChange ? DirtyEnabled : DirtyToolTip);
+            return false;
+        }
+        auto index = indexOf(widget);
+        if (-1 != index) {
+            if (isEnabledChange) {
+                tabBar()->setTabEnabled(index, widget->isEnabled());
+            } else {
+                tabBar()->setTabToolTip(index, widget->toolTip());
+            }
+        }
+    }
+    return false;
+}
+
+void TabWidgetPlus::setCoalescedUpdates(bool enabled, int intervalMs)
+{
+    if (!enabled) {
+        if (nullptr != flushTimer) {
+            flushDirtyTabs();
+            delete flushTimer;
+            flushTimer = nullptr;
+        }
+        return;
+    }
+    if (nullptr == flushTimer) {
+        flushTimer = new QTimer(this);
+        flushTimer->setSingleShot(true);
+        connect(flushTimer, &QTimer::timeout, this, &TabWidgetPlus::flushDirtyTabs);
+    }
+    flushTimer->setInterval(intervalMs);
+}
+
+bool TabWidgetPlus::coalescedUpdates() const
+{
+    return nullptr != flushTimer;
+}
+
+quint64 TabWidgetPlus::avoidedRelayouts() const
+{
+    return avoidedRelayoutCount;
+}
+
+void TabWidgetPlus::markDirty(QWidget *widget, unsigned char flag)
+{
+    auto entry = registry.find(widget);
+    if (nullptr == entry) {
+        return;
+    }
+    if (0 != (entry->dirty & flag)) {
+        // Already pending:  this change rides along with that update.
+        ++avoidedRelayoutCount;
+        return;
+    }
+    if (0 == entry->dirty) {
+        dirtyWidgets.push_back(widget);
+    }
+    entry->dirty |= flag;
+    if (!flushTimer->isActive()) {
+        flushTimer->start();
+    }
+}
+
+void TabWidgetPlus::flushDirtyTabs()
+{
+    //
+    // Apply the latest state of every dirty tab.  Hidden tabs are
+    // skipped:  tabInserted() reads everything fresh when they come
+    // back.  Widgets deleted in the meantime no longer have an entry.
+    //
+    std::vector<QWidget *> widgets;
+    widgets.swap(dirtyWidgets);
+    for (auto widget : widgets) {
+        auto entry = registry.find(widget);
+        if (nullptr == entry) {
+            continue;
+        }
+        auto flags = entry->dirty;
+        entry->dirty = 0;
+        if (entry->hidden) {
+            continue;
+        }
+        auto index = registry.visibleIndex(entry);
+        if (0 != (flags & DirtyText)) {
+            if (tabBar()->tabText(index) != widget->windowTitle()) {
+                tabBar()->setTabText(index, widget->windowTitle());
+                TABWIDGETPLUS_COUNT(countRelayout());
+            } else {
+                ++avoidedRelayoutCount;
+            }
+        }
+        if (0 != (flags & DirtyEnabled)) {
+            if (tabBar()->isTabEnabled(index) != widget->isEnabled()) {
+                tabBar()->setTabEnabled(index, widget->isEnabled());
+            } else {
+                ++avoidedRelayoutCount;
+            }
+        }
+        if (0 != (flags & DirtyToolTip)) {
+            if (tabBar()->tabToolTip(index) != widget->toolTip()) {
+                tabBar()->setTabToolTip(index, widget->toolTip());
+            } else {
+                ++avoidedRelayoutCount;
+            }
+        }
+    }
+}
+
+bool TabWidgetPlus::setVirtualized(bool enabled)
+{
+    if (enabled == isVirtualized()) {
+        return true;
+    }
+    if (0 != count()) {
+        // QTabWidget can't move existing tabs to a new tab bar.
+        return false;
+    }
+    auto movable = isMovable();
+    if (enabled) {
+        setTabBar(new VirtualTabBar(this));
+        searchButton = new QToolButton(this);
+        searchButton->setAutoRaise(true);
+        searchButton->setText(QStringLiteral("\u2026"));
+        searchButton->setToolTip(tr("Find tab"));
+        connect(searchButton, &QToolButton::clicked,
+                this, &TabWidgetPlus::showTabSearch);
+        setCornerWidget(searchButton, Qt::TopRightCorner);
+    } else {
+        setTabBar(new QTabBar(this));
+        setCornerWidget(nullptr, Qt::TopRightCorner);
+        delete searchButton;
+        searchButton = nullptr;
+    }
+    setMovable(movable);
+    connect(tabBar(), &QTabBar::tabMoved, this, &TabWidgetPlus::followTabMove);
+    if (nullptr != tracer) {
+        tabBar()->installEventFilter(this);
+    }
+    return true;
+}
+
+bool TabWidgetPlus::isVirtualized() const
+{
+    return nullptr != qobject_cast<VirtualTabBar *>(tabBar());
+}
+
+void TabWidgetPlus::showTabSearch()
+{
+    if (nullptr == searchPopup) {
+        searchPopup = new TabSearchPopup(this);
+    }
+    QWidget *anchor = tabBar();
+    if (nullptr != searchButton) {
+        anchor = searchButton;
+    }
+    searchPopup->popup(anchor->mapToGlobal(QPoint(0, anchor->height())));
+}
+
+int TabWidgetPlus::indexOf(QWidget *widget) const
+{
+    auto entry = registry.find(widget);
+    if (nullptr == entry || entry->hidden) {
+        return -1;
+    }
+    return registry.visibleIndex(entry);
+}
+
+void TabWidgetPlus::setPreviewCacheLimit(qint64 maxBytes, const QSize &size)
+{
+    if (maxBytes <= 0) {
+        delete previewCache;
+        previewCache = nullptr;
+        return;
+    }
+    if (nullptr == previewCache) {
+        previewCache = new TabPreviewCache(this);
+        connect(previewCache, &TabPreviewCache::previewReady,
+                this, &TabWidgetPlus::previewReady);
+    }
+    previewCache->setMaxBytes(maxBytes);
+    previewCache->setThumbnailSize(size);
+}
+
+qint64 TabWidgetPlus::previewCacheLimit() const
+{
+    return nullptr == previewCache ? 0 : previewCache->maxBytes();
+}
+
+QPixmap TabWidgetPlus::preview(QWidget *widget) const
+{
+    if (nullptr == previewCache) {
+        return QPixmap();
+    }
+    return previewCache->preview(widget);
+}
+
+void TabWidgetPlus::setActivationTracing(bool enabled)
+{
+    if (enabled == (nullptr != tracer)) {
+        return;
+    }
+    if (enabled) {
+        tracer = new TabActivationTracer(this);
+        // Paints of the tab bar end showTab() spans.
+        tabBar()->installEventFilter(this);
+    } else {
+        tabBar()->removeEventFilter(this);
+        delete tracer;
+        tracer = nullptr;
+    }
+}
+
+TabActivationTracer *TabWidgetPlus::activationTracer() const
+{
+    return tracer;
+}
+
+TabCommandQueue *TabWidgetPlus::commandQueue() const
+{
+    return commands;
+}
+
+TabGroup *TabWidgetPlus::group() const
+{
+    return tabGroup;
+}
+
+TabWidgetPlus::TabId TabWidgetPlus::nextTabId()
+{
+    // 0 lets the registry count on its own.
+    return nullptr == tabGroup ? 0 : tabGroup->nextId();
+}
+
+void TabWidgetPlus::releaseTab(QWidget *widget, MovedTab &tab)
+{
+    //
+    // Take the tab out the way hideTab() would, then drop the entry
+    // without touching the hooks (they belong to the group).  A tab
+    // the filter hid counts as visible:  the new view decides for
+    // itself.
+    //
+    auto entry = registry.find(widget);
+    tab.id = entry->id;
+    tab.hidden = entry->hidden && !entry->filteredOut;
+    if (entry->hidden) {
+        tab.title = widget->windowTitle();
+    } else {
+        auto index = registry.visibleIndex(entry);
+        tab.title = tabText(index);
+        tab.icon = tabIcon(index);
+        pendingHide = widget;
+        removeTab(index);
+        pendingHide = nullptr;
+    }
+    if (nullptr != previewCache) {
+        previewCache->invalidate(widget);
+    }
+    registry.erase(entry);
+
+    auto lazyPage = qobject_cast<LazyTabPage *>(widget);
+    if (nullptr != lazyPage) {
+        disconnect(lazyPage, nullptr, this, nullptr);
+        livePages.erase(std::remove(livePages.begin(), livePages.end(), lazyPage),
+                        livePages.end());
+        auto ready = std::remove(readyPages.begin(), readyPages.end(), lazyPage);
+        tab.waitingToBuild = ready != readyPages.end();
+        readyPages.erase(ready, readyPages.end());
+    }
+    announceRelease(widget);
+}
+
+void TabWidgetPlus::adoptTab(QWidget *widget, const MovedTab &tab, int index)
+{
+    //
+    // Start from a hidden entry where the tab belongs; showing it is
+    // then the same as showTab(), and tabInserted() finds the entry
+    // already in place.
+    //
+    auto entry = registry.insert(widget, registry.visibleAt(index), tab.id);
+    registry.setHidden(entry, true);
+    if (tab.hidden) {
+        parkHiddenPage(widget, tab.title);
+    } else {
+        insertTab(registry.visibleIndex(entry), widget, tab.icon, tab.title);
+    }
+
+    auto lazyPage = qobject_cast<LazyTabPage *>(widget);
+    if (nullptr != lazyPage) {
+        watchLazyPage(lazyPage);
+        if (tab.waitingToBuild) {
+            queueBuild(lazyPage);
+        }
+        enforceEvictionPolicy();
+    }
+    if (filter) {
+        queueRefilter(widget);
+    }
+}
+
+TabWidgetStats TabWidgetPlus::stats() const
+{
+    auto result = statsData;
+#ifdef TABWIDGETPLUS_STATS
+    result.enabled = true;
+#endif
+    result.tabCount = static_cast<int>(registry.size());
+    result.hiddenTabCount = static_cast<int>(registry.hiddenCount());
+    return result;
+}
+
+void TabWidgetPlus::resetStats()
+{
+    statsData = TabWidgetStats();
+}
+
+void TabWidgetPlus::setStatsInterval(int msecs)
+{
+    if (msecs <= 0) {
+        delete statsTimer;
+        statsTimer = nullptr;
+        return;
+    }
+    if (nullptr == statsTimer) {
+        statsTimer = new QTimer(this);
+        connect(statsTimer, &QTimer::timeout, this, [ = ]() {
+            emit statsUpdated(stats());
+        });
+    }
+    statsTimer->start(msecs);
+}
+
+int TabWidgetPlus::statsInterval() const
+{
+    return nullptr == statsTimer ? 0 : statsTimer->interval();
+}
+
+TabMemoryReport TabWidgetPlus::memoryReport() const
+{
+    TabMemoryReport result;
+    result.pages.reserve(registry.size());
+    auto &overhead = result.overhead;
+    for (auto entry = registry.first(); nullptr != entry;
+            entry = registry.next(entry)) {
+        TabMemoryReport::Page page;
+        page.id = entry->id;
+        page.title = tabTitle(entry);
+        page.objectName = entry->widget->objectName();
+        page.hidden = entry->hidden;
+        TabMemoryReport::measure(entry->widget, page);
+        if (nullptr != previewCache) {
+            page.previewBytes = previewCache->bytes(entry->widget);
+        }
+
+        // The destroyed and title connections and the event filter
+        // (ours, or the group's while in a TabGroup).
+        ++overhead.entries;
+        overhead.connections += 2;
+        ++overhead.eventFilters;
+        auto lazyPage = qobject_cast<LazyTabPage *>(entry->widget);
+        if (nullptr != lazyPage) {
+            page.lazy = true;
+            page.built = lazyPage->isMaterialized();
+            page.lastActivated = lazyPage->lastActivated();
+            // materialized and evicted (see watchLazyPage()).
+            overhead.connections += 2;
+        }
+        result.pages.push_back(page);
+    }
+
+    overhead.registryBytes = static_cast<qint64>(registry.memoryBytes());
+    overhead.connectionBytes = qint64(overhead.connections)
+                               * TabMemoryReport::ConnectionCost;
+    overhead.eventFilterBytes = qint64(overhead.eventFilters)
+                                * TabMemoryReport::EventFilterCost;
+    overhead.queueBytes = static_cast<qint64>(
+                              livePages.capacity() * sizeof(livePages[0])
+                              + readyPages.capacity() * sizeof(readyPages[0])
+                              + dirtyWidgets.capacity() * sizeof(dirtyWidgets[0])
+                              + filterQueue.capacity() * sizeof(filterQueue[0])
+                              + batchActivity.capacity() * sizeof(batchActivity[0]));
+    return result;
+}
+
+void TabWidgetPlus::setMemoryReportInterval(int msecs, const QString &path)
+{
+    if (msecs <= 0) {
+        delete memoryReportTimer;
+        memoryReportTimer = nullptr;
+        return;
+    }
+    memoryReportPath = path;
+    if (nullptr == memoryReportTimer) {
+        memoryReportTimer = new QTimer(this);
+        connect(memoryReportTimer, &QTimer::timeout, this, [ = ]() {
+            auto report = memoryReport();
+            if (!memoryReportPath.isEmpty()) {
+                report.save(memoryReportPath);
+            }
+            emit memoryReportUpdated(report);
+        });
+    }
+    memoryReportTimer->start(msecs);
+}
+
+int TabWidgetPlus::memoryReportInterval() const
+{
+    return nullptr == memoryReportTimer ? 0 : memoryReportTimer->interval();
+}
+
+void TabWidgetPlus::countRelayout()
+{
+    // QTabBar only lays itself out while it is shown (see BatchScope).
+    if (tabBar()->isVisible()) {
+        ++statsData.relayouts;
+    }
+}
+
+bool TabWidgetPlus::checkConsistency() const
+{
+#ifdef NDEBUG
+    return true;
+#else
+    //
+    // In the spirit of the order check in FormTabTester:  the registry
+    // must list exactly the base class's tabs, in the same order, and
+    // indexOf() must agree with QTabWidget::indexOf().
+    //
+    auto total = count();
+    if (registry.size() - registry.hiddenCount() != static_cast<std::size_t>(total)) {
+        return false;
+    }
+    for (auto index = 0; index < total; ++index) {
+        auto tab = QTabWidget::widget(index);
+        auto entry = registry.find(tab);
+        if (nullptr == entry || entry->hidden || registry.visibleAt(index) != entry
+                || registry.visibleIndex(entry) != index) {
+            return false;
+        }
+        if (indexOf(tab) != QTabWidget::indexOf(tab)) {
+            return false;
+        }
+    }
+    for (auto entry = registry.first(); nullptr != entry;
+            entry = registry.next(entry)) {
+        if (entry->hidden && -1 != QTabWidget::indexOf(entry->widget)) {
+            return false;
+        }
+    }
+    return true;
+#endif
+}
+
+TabWidgetPlus::tabWidgetState TabWidgetPlus::tabState( QWidget *widget) const
+{
+    auto entry = registry.find(widget);
+    return nullptr == entry ? tabWidgetState::unknown : stateOf(entry);
+}
+
+TabWidgetPlus::tabWidgetState TabWidgetPlus::stateOf(const TabRegistry::Entry *entry) const
+{
+    if (entry->hidden) {
+        return tabWidgetState::hidden;
+    }
+    auto lazyPage = qobject_cast<LazyTabPage *>(entry->widget);
+    if (nullptr != lazyPage && !lazyPage->isMaterialized()) {
+        return tabWidgetState::unmaterialized;
+    }
+    return tabWidgetState::visible;
+}
+
+TabWidgetPlus::tabActivityLevel TabWidgetPlus::activityLevel(QWidget *widget) const
+{
+    auto entry = registry.find(widget);
+    return nullptr == entry ? tabActivityLevel::hidden : activityOf(entry);
+}
+
+TabWidgetPlus::tabActivityLevel TabWidgetPlus::activityOf(const TabRegistry::Entry *entry) const
+{
+    if (entry->hidden) {
+        return tabActivityLevel::hidden;
+    }
+    if (!shownOnScreen) {
+        return tabActivityLevel::background;
+    }
+    return entry->widget == currentWidget() ? tabActivityLevel::current
+           : tabActivityLevel::visible;
+}
+
+void TabWidgetPlus::setActivityTracking(bool enabled)
+{
+    if (enabled == trackActivity) {
+        return;
+    }
+    trackActivity = enabled;
+    if (enabled) {
+        publishAllActivity();
+        return;
+    }
+    for (auto entry = registry.first(); nullptr != entry;
+            entry = registry.next(entry)) {
+        entry->activity = 0xff;
+        entry->widget->setProperty(activityProperty, QVariant());
+    }
+}
+
+bool TabWidgetPlus::activityTracking() const
+{
+    return trackActivity;
+}
+
+void TabWidgetPlus::announceRelease(QWidget *widget)
+{
+    if (trackActivity) {
+        widget->setProperty(activityProperty, QVariant());
+    }
+    if (0 != batchDepth) {
+        batchReleased.push_back(widget);
+        return;
+    }
+    emit tabReleased(widget);
+}
+
+void TabWidgetPlus::publishActivity(TabRegistry::Entry *entry)
+{
+    //
+    // Only a real change is published, so callers can call this for
+    // any tab that might have changed.  Most changes touch one or two
+    // tabs; only showing or hiding the whole tab widget touches all.
+    //
+    if (!trackActivity) {
+        return;
+    }
+    if (0 != batchDepth) {
+        batchActivity.push_back(entry->widget);
+        return;
+    }
+    auto level = activityOf(entry);
+    if (static_cast<unsigned char>(level) == entry->activity) {
+        return;
+    }
+    entry->activity = static_cast<unsigned char>(level);
+    entry->widget->setProperty(activityProperty, static_cast<int>(level));
+    emit activityLevelChanged(entry->widget, level);
+}
+
+void TabWidgetPlus::publishAllActivity()
+{
+    for (auto entry = registry.first(); nullptr != entry;
+            entry = registry.next(entry)) {
+        publishActivity(entry);
+    }
+}
+
+void TabWidgetPlus::showEvent(QShowEvent *event)
+{
+    QTabWidget::showEvent(event);
+    shownOnScreen = true;
+    publishAllActivity();
+}
+
+void TabWidgetPlus::hideEvent(QHideEvent *event)
+{
+    QTabWidget::hideEvent(event);
+    shownOnScreen = false;
+    publishAllActivity();
+}
+
+TabWidgetPlus::HiddenTabs TabWidgetPlus::hiddenTabs() const
+{
+    return registry.hiddenEntries();
+}
+
+quint64 TabWidgetPlus::tabsGeneration() const
+{
+    return registry.generation() + lazyPageChanges;
+}
+
+TabWidgetPlus::TabId TabWidgetPlus::tabId(QWidget *widget) const
+{
+    auto entry = registry.find(widget);
+    return nullptr == entry ? 0 : entry->id;
+}
+
+QWidget *TabWidgetPlus::widgetForId(TabId id) const
+{
+    auto entry = registry.findId(id);
+    return nullptr == entry ? nullptr : entry->widget;
+}
+
+TabWidgetPlus::tabWidgetState TabWidgetPlus::tabStateById(TabId id) const
+{
+    auto widget = widgetForId(id);
+    return nullptr == widget ? tabWidgetState::unknown : tabState(widget);
+}
+
+void TabWidgetPlus::hideTabById(TabId id)
+{
+    auto widget = widgetForId(id);
+    if (nullptr != widget) {
+        hideTab(widget);
+    }
+}
+
+void TabWidgetPlus::showTabById(TabId id)
+{
+    auto widget = widgetForId(id);
+    if (nullptr != widget) {
+        showTab(widget);
+    }
+}
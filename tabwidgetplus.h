@@ -24,27 +24,380 @@
 #ifndef TABWIDGETPLUS_H
 #define TABWIDGETPLUS_H
 
+#include "lazytabpage.h"
+#include "tabmemoryreport.h"
+#include "tabregistry.h"
+#include "tabwidgetstats.h"
+#include <QEvent>
+#include <QIcon>
+#include <QList>
+#include <QPixmap>
+#include <QPointer>
 #include <QTabWidget>
-#include <deque>
+#include <functional>
+#include <vector>
+
+class QRegularExpression;
+class QTimer;
+class QToolButton;
+class TabActivationTracer;
+class TabCommandQueue;
+class TabGroup;
+class TabPreviewCache;
+class TabSearchPopup;
 
 class TabWidgetPlus : public QTabWidget
 {
     Q_OBJECT
 public:
     explicit TabWidgetPlus(QWidget *parent = 0);
-    virtual ~TabWidgetPlus() = default;
+    virtual ~TabWidgetPlus();
 
-    enum class tabWidgetState { unknown, hidden, visible };
+    // 'unmaterialized' is a lazy tab that is in the tab bar but whose
+    // page hasn't been built yet (see addLazyTab()).
+    enum class tabWidgetState { unknown, hidden, visible, unmaterialized };
     tabWidgetState tabState( QWidget *tab) const;
+
+    /**
+     * @brief Stable handle for a tab.
+     *
+     * A tab gets its ID when it is added and keeps it while it is
+     * hidden, shown, moved, filtered or restored by restoreLayout().
+     * The ID is retired when the tab is removed or its widget is
+     * destroyed, and is never handed out again, so a stale ID simply
+     * finds nothing.  0 is never a valid ID.
+     *
+     * The ID calls are named apart from tabState()/hideTab()/showTab()
+     * rather than overloading them, so that &TabWidgetPlus::hideTab
+     * still names one slot and hideTab(0) isn't ambiguous.
+     */
+    typedef quint64 TabId;
+    TabId tabId(QWidget *widget) const;
+    QWidget *widgetForId(TabId id) const;
+    tabWidgetState tabStateById(TabId id) const;
+    void hideTabById(TabId id);
+    void showTabById(TabId id);
+
+    /**
+     * @brief Walk every tab, hidden or not, in display order.
+     *
+     * The visitor is called with a TabInfo for each tab.  The walk is
+     * O(total tabs) and allocates nothing, so it is cheap enough to
+     * poll.  The visitor must not add, remove, hide or show tabs.
+     */
+    struct TabInfo {
+        TabId id;
+        QWidget *widget;
+        tabWidgetState state;
+        // The tab's index, or -1 for a hidden tab.
+        int index;
+    };
+    template<typename Visitor>
+    void forEachTab(Visitor visitor) const;
+
+    /**
+     * @brief How much a tab's page is worth spending time on.
+     *
+     * 'current' is the current tab while the tab widget is on screen,
+     * 'visible' any other tab in the tab bar, 'background' every tab in
+     * the tab bar while the tab widget itself isn't shown, and 'hidden'
+     * a tab taken out with hideTab() or the filter.
+     */
+    enum class tabActivityLevel { current, visible, background, hidden };
+    tabActivityLevel activityLevel(QWidget *widget) const;
+
+    /**
+     * @brief Publish every tab's activity level as it changes.
+     *
+     * While on, each page carries its level as an int in the dynamic
+     * property named by activityProperty (so the page gets a
+     * DynamicPropertyChange event), and activityLevelChanged() is
+     * emitted.  See TabTimerThrottle for a ready-made listener.
+     */
+    void setActivityTracking(bool enabled);
+    bool activityTracking() const;
+    static const char *const activityProperty;
+
+    // The hidden tabs' widgets, in display order, for a range-based
+    // for loop.  Allocates nothing; good until the tabs next change.
+    typedef TabRegistry::HiddenRange HiddenTabs;
+    HiddenTabs hiddenTabs() const;
+
+    // Changes whenever a tab is added, removed, moved, hidden or shown,
+    // or a lazy page is built or evicted, so a poller can skip the walk
+    // when it is the same as last time.
+    quint64 tabsGeneration() const;
+
+    /**
+     * @brief Index of the tab for a widget, or -1 if it isn't visible.
+     *
+     * Same answer as QTabWidget::indexOf(), but counted in the registry
+     * (O(log n)) instead of a linear search of the stacked widget.
+     * Inside a slot the base class calls while adding or removing a tab
+     * (before tabInserted() or tabRemoved()), the answer is the index
+     * from before that change.
+     */
+    int indexOf(QWidget *widget) const;
+
+    /**
+     * @brief Check the hidden-tab registry against QTabWidget.
+     *
+     * Meant for tests and debug builds (it is O(n log n)).  In release
+     * builds (NDEBUG) it does nothing and returns true.
+     *
+     * @return true if everything agrees with the base class.
+     */
+    bool checkConsistency() const;
+
+    /**
+     * @brief Add a tab whose page is only built when it is first needed.
+     *
+     * The tab gets a lightweight LazyTabPage as its widget, and the
+     * factory is called to build the real page the first time the tab
+     * becomes current.  The LazyTabPage (widget(index)) remains the
+     * tab's widget for good, so use it with hideTab()/showTab().
+     *
+     * @return The index of the new tab, as with addTab().
+     */
+    int addLazyTab(std::function<QWidget *()> factory, const QString &title,
+                   const QIcon &icon = QIcon());
+    int insertLazyTab(int index, std::function<QWidget *()> factory,
+                      const QString &title, const QIcon &icon = QIcon());
+
+    /**
+     * @brief Add a tab whose data is prepared on a worker thread.
+     *
+     * 'prepare' starts on the global thread pool right away (it must
+     * not touch widgets); meanwhile the tab shows a busy placeholder.
+     * Once the data is ready, 'build' makes the real page from it on
+     * the GUI thread.  Ready pages are built one per event loop turn,
+     * the current tab first, then visible tabs, then hidden ones, so
+     * opening many tabs at once never stalls the GUI for long.  The
+     * tab's widget is a LazyTabPage throughout, as with addLazyTab().
+     *
+     * @return The index of the new tab, as with addTab().
+     */
+    int addAsyncTab(LazyTabPage::Preparer prepare, LazyTabPage::Builder build,
+                    const QString &title, const QIcon &icon = QIcon());
+    int insertAsyncTab(int index, LazyTabPage::Preparer prepare,
+                       LazyTabPage::Builder build, const QString &title,
+                       const QIcon &icon = QIcon());
+
+    /**
+     * @brief Limits on how many lazy pages stay built at once.
+     *
+     * Only lazy tabs can be evicted, since only they know how to build
+     * their page again.  The current tab is never evicted.  Pages are
+     * evicted least recently activated (or built) first.
+     */
+    struct EvictionPolicy {
+        // Most lazy pages kept built at once; 0 means no limit.
+        int maxLivePages = 0;
+        // Most estimated bytes kept built at once; 0 means no limit.
+        qint64 maxBytes = 0;
+        // Evict a lazy page as soon as its tab is hidden.
+        bool evictHidden = false;
+        // Estimated size of one built page.  A rough guess based on
+        // the page's size and number of children is used if empty.
+        std::function<qint64(QWidget *)> estimateBytes;
+    };
+    void setEvictionPolicy(const EvictionPolicy &policy);
+    EvictionPolicy evictionPolicy() const;
+
+    /**
+     * @brief Collect tab text, enabled and tooltip changes and apply them later.
+     *
+     * Normally each change to a page's window title, enabled state or
+     * tooltip updates the tab bar (and relays it out) right away.  With
+     * coalescing on, changes only mark the tab dirty, and all pending
+     * changes are applied together after 'intervalMs' milliseconds:
+     * 0 means the next event loop turn, 16 is about once per frame.
+     * Turning coalescing off applies anything still pending.
+     */
+    void setCoalescedUpdates(bool enabled, int intervalMs = 0);
+    bool coalescedUpdates() const;
+
+    // Number of tab bar updates skipped because coalescing merged
+    // them into another update, or found nothing had changed.
+    quint64 avoidedRelayouts() const;
+
+    /**
+     * @brief Switch to a tab bar built for tens of thousands of tabs.
+     *
+     * Uses a VirtualTabBar, which caches tab sizes and paints only the
+     * tabs on screen, and adds a corner button that opens a searchable
+     * list of all tabs (see showTabSearch()).  Hidden tabs behave as
+     * before.  The tab bar can only be swapped while there are no tabs
+     * in it.
+     *
+     * @return false if there are tabs in the tab bar.
+     */
+    bool setVirtualized(bool enabled);
+    bool isVirtualized() const;
+
+    /**
+     * @brief Show only the tabs a predicate accepts.
+     *
+     * Tabs the predicate rejects are hidden as with hideTab(), all in
+     * one BatchScope, and come back at their old places when they are
+     * accepted again or the filter is cleared.  Tabs hidden with
+     * hideTab() are left alone.  A tab whose window title changes, or
+     * that is added while a filter is set, is checked again on the next
+     * event loop turn.  showTab() on a filtered-out tab shows it anyway.
+     *
+     * An empty predicate clears the filter.
+     */
+    void setFilter(std::function<bool(QWidget *)> accepts);
+
+    // Shortcut: show only the tabs whose title matches the pattern.
+    void setFilter(const QRegularExpression &titlePattern);
+    void clearFilter();
+    bool isFiltered() const;
+
+    /**
+     * @brief Save every tab's place, title, enabled flag and visibility.
+     *
+     * Hidden tabs are saved where they sit among the visible ones, so
+     * they come back at the same index when shown after a restore.
+     * Tabs are identified by their widget's objectName(), the way
+     * QMainWindow::saveState() identifies its toolbars.
+     *
+     * @return A versioned binary blob for restoreLayout().
+     */
+    QByteArray saveLayout() const;
+
+    /**
+     * @brief Rebuild the tabs from a saveLayout() result in one pass.
+     *
+     * Saved tabs are matched by objectName() with the widgets this tab
+     * widget already has (hidden or not); 'resolve' is asked for any it
+     * doesn't have, and a saved tab is skipped if it returns nullptr.
+     * Tabs that aren't in the layout keep their state and follow the
+     * restored ones.  A filter set with setFilter() is applied to the
+     * restored tabs, and tabs it hides come back when it is cleared.
+     * The whole restore runs inside a BatchScope, and hidden tabs never
+     * enter the tab bar, so restoring into an empty tab widget (all
+     * pages from 'resolve') is O(n log n).
+     *
+     * @return false, with nothing changed, if 'layout' can't be read.
+     */
+    bool restoreLayout(const QByteArray &layout,
+                       std::function<QWidget *(const QString &name)> resolve = nullptr);
+
+    /**
+     * @brief Keep small renders of background and hidden pages.
+     *
+     * A page is captured when it stops being current and when it is
+     * hidden with hideTab() outside a BatchScope (capturing renders the
+     * page, so bulk hides skip it), and its preview is dropped when the
+     * page repaints (paint events of the page widget itself, not of its
+     * children).  Scaling runs on a worker thread; previewReady() is
+     * emitted once a preview is available.  Previews past 'maxBytes'
+     * are dropped least recently used first.  0 turns the cache off.
+     */
+    void setPreviewCacheLimit(qint64 maxBytes, const QSize &size = QSize(256, 160));
+    qint64 previewCacheLimit() const;
+
+    // The cached preview for a page, or a null pixmap if there is none.
+    QPixmap preview(QWidget *widget) const;
+
+    /**
+     * @brief Time tab switches and showTab() until they are painted.
+     *
+     * See TabActivationTracer for what is measured and how to export
+     * it.  activationTracer() is nullptr while tracing is off.
+     */
+    void setActivationTracing(bool enabled);
+    TabActivationTracer *activationTracer() const;
+
+    /**
+     * @brief Queue for changing the tabs from other threads.
+     *
+     * Safe to call from any thread; see TabCommandQueue.
+     */
+    TabCommandQueue *commandQueue() const;
+
+    // The TabGroup this tab widget is a view of, or nullptr.  Tab IDs
+    // are unique across every view of a group (see TabGroup::addView()).
+    TabGroup *group() const;
+
+    /**
+     * @brief Counters and timings for this tab widget's hot paths.
+     *
+     * Collected only in builds with TABWIDGETPLUS_STATS defined; see
+     * TabWidgetStats.  The snapshot is a copy, so it is safe to keep.
+     * There is no longer an index scan count:  indexOf() asks the tab
+     * registry for the position instead of scanning a cache.
+     */
+    TabWidgetStats stats() const;
+    void resetStats();
+
+    // Emit statsUpdated() every 'msecs' milliseconds (0 stops it).
+    void setStatsInterval(int msecs);
+    int statsInterval() const;
+
+    /**
+     * @brief Estimated memory used by every page and by TabWidgetPlus.
+     *
+     * Nothing is collected between calls:  the report walks every tab
+     * and its page's widget tree when asked, so it costs O(widgets) and
+     * is best polled slowly.  See TabMemoryReport for what the
+     * estimates cover.
+     */
+    TabMemoryReport memoryReport() const;
+
+    // Every 'msecs' milliseconds (0 stops it), emit memoryReportUpdated()
+    // and, unless 'path' is empty, write the report there as JSON.
+    void setMemoryReportInterval(int msecs, const QString &path = QString());
+    int memoryReportInterval() const;
+
+    /**
+     * @brief Group several tab changes into a single update.
+     *
+     * While at least one BatchScope is alive, tab bar painting and
+     * signals from the tab widget are suspended and the tab bar is not
+     * laid out.  The pages are left alone.  When the last one goes away
+     * the tab bar repaints once, and currentChanged() is emitted once if
+     * the current tab changed.
+     */
+    class BatchScope
+    {
+    public:
+        explicit BatchScope(TabWidgetPlus *tabWidget);
+        ~BatchScope();
+
+    private:
+        Q_DISABLE_COPY(BatchScope)
+        TabWidgetPlus *tabWidget;
+    };
+
 signals:
+    void statsUpdated(const TabWidgetStats &stats);
+    void memoryReportUpdated(const TabMemoryReport &report);
+    void previewReady(QWidget *widget);
+    void activityLevelChanged(QWidget *widget, TabWidgetPlus::tabActivityLevel level);
+
+    // A page stopped being one of our tabs without being destroyed
+    // (removeTab(), or moved to another view of its TabGroup), so
+    // whatever was done to it for its activity level should be undone.
+    void tabReleased(QWidget *widget);
 
 public slots:
     void hideTab(QWidget *widget);
     void showTab(QWidget *widget);
 
+    // Hide or show many tabs inside a single BatchScope.
+    void hideTabs(const QList<QWidget *> &widgets);
+    void showTabs(const QList<QWidget *> &widgets);
+
+    // Pop up a filterable list of the tabs in the tab bar.
+    void showTabSearch();
+
 protected:
     virtual void tabInserted(int index) override;
     virtual void tabRemoved(int index) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
 
     // methods called from the lambda slot methods in tabInserted().
     virtual void removeHiddenTabData(QWidget *widget);
@@ -53,12 +406,160 @@ protected:
     // event filter installed for tab objects in tabInserted().
     bool eventFilter(QObject *obj, QEvent *event) override;
 
-    // Tracked data for hidden tabs.
-    struct HiddenTab {
-        int index = -1;
-        QWidget *widget = nullptr;
+    // The only page events eventFilter() ever acts on.  Busy pages get
+    // far more events than these, so this test comes before anything
+    // else in the filter.
+    static bool isTrackedEvent(QEvent::Type type)
+    {
+        return QEvent::EnabledChange == type || QEvent::ToolTipChange == type
+               || QEvent::Paint == type;
+    }
+
+    // Tracked data for all tabs, hidden or not, in display order.
+    TabRegistry registry;
+
+    // The widget hideTab() is removing, so that tabRemoved() knows
+    // to keep its entry (as hidden) instead of forgetting it.
+    QWidget *pendingHide = nullptr;
+
+private slots:
+    void activateCurrent();
+    void enforceEvictionPolicy();
+    void flushDirtyTabs();
+    void followTabMove(int from, int to);
+    void flushFilterQueue();
+    void buildNextPage();
+
+private:
+    friend class TabCommandQueue;
+    friend class TabGroup;
+
+    // A tab on its way from one view of a TabGroup to another.
+    struct MovedTab {
+        TabId id = 0;
+        QString title;
+        QIcon icon;
+        bool hidden = false;
+        // An asynchronous page whose data is ready but not yet built.
+        bool waitingToBuild = false;
+    };
+    void releaseTab(QWidget *widget, MovedTab &tab);
+    void adoptTab(QWidget *widget, const MovedTab &tab, int index);
+    void parkHiddenPage(QWidget *widget, const QString &title);
+    void watchLazyPage(LazyTabPage *page);
+    void queueBuild(LazyTabPage *page);
+    TabId nextTabId();
+    tabWidgetState stateOf(const TabRegistry::Entry *entry) const;
+    tabActivityLevel activityOf(const TabRegistry::Entry *entry) const;
+    void publishActivity(TabRegistry::Entry *entry);
+    void publishAllActivity();
+    void announceRelease(QWidget *widget);
+
+    void trackWidget(TabRegistry::Entry *entry);
+    void untrackWidget(TabRegistry::Entry *entry);
+    void forgetTab(TabRegistry::Entry *entry);
+    void hideTabAt(int index, QWidget *widget);
+    void addHiddenTab(QWidget *widget, const QString &title);
+    void markDirty(QWidget *widget, unsigned char flag);
+    void beginBatch();
+    void endBatch();
+    void countRelayout();
+    void refilter(const std::vector<QWidget *> &widgets);
+    void refilterAll();
+    void queueRefilter(QWidget *widget);
+    QString tabTitle(const TabRegistry::Entry *entry) const;
+
+    // State saved by the outermost BatchScope.
+    int batchDepth = 0;
+    QPointer<QWidget> batchCurrent;
+    bool batchTabBarUpdates = true;
+    bool batchSignalsBlocked = false;
+    bool batchTabBarVisible = false;
+
+    // Lazy pages that are currently built, for the eviction policy.
+    EvictionPolicy eviction;
+    std::vector<QPointer<LazyTabPage>> livePages;
+    quint64 activationCount = 0;
+
+    // Lazy pages built or evicted, for tabsGeneration().
+    quint64 lazyPageChanges = 0;
+
+    // Asynchronous pages whose data is ready, waiting to be built one
+    // per event loop turn (see addAsyncTab()).
+    QTimer *buildTimer = nullptr;
+    std::vector<QPointer<LazyTabPage>> readyPages;
+
+    // Pending tab bar changes while coalescing (see markDirty()).
+    enum DirtyFlag : unsigned char {
+        DirtyText = 0x01,
+        DirtyEnabled = 0x02,
+        DirtyToolTip = 0x04
     };
-    std::deque<HiddenTab> hidden;
+    QTimer *flushTimer = nullptr;
+    std::vector<QWidget *> dirtyWidgets;
+    quint64 avoidedRelayoutCount = 0;
+
+    // See setFilter().  The queue holds tabs to check again once the
+    // (zero interval) timer fires.
+    std::function<bool(QWidget *)> filter;
+    QTimer *filterTimer = nullptr;
+    std::vector<QWidget *> filterQueue;
+
+    // See setPreviewCacheLimit().  previousCurrent is the page to
+    // capture when the current tab changes.
+    TabPreviewCache *previewCache = nullptr;
+    QPointer<QWidget> previousCurrent;
+
+    // See setActivationTracing().
+    TabActivationTracer *tracer = nullptr;
+
+    // See setActivityTracking().  Shown between our show and hide
+    // events, which (unlike isVisible()) also follow minimizing.
+    bool trackActivity = false;
+    bool shownOnScreen = false;
+
+    // Tabs whose level may have changed, and pages let go of, inside a
+    // BatchScope, where signals are blocked; published when the batch
+    // ends.
+    std::vector<QWidget *> batchActivity;
+    std::vector<QPointer<QWidget>> batchReleased;
+
+    // Created with the tab widget, so other threads never race to
+    // create it.
+    TabCommandQueue *commands = nullptr;
+
+    // See TabGroup.  While set, the group owns the per-widget hooks
+    // and hands out the tab IDs.
+    TabGroup *tabGroup = nullptr;
+
+    // Created on first use by showTabSearch() / setVirtualized().
+    TabSearchPopup *searchPopup = nullptr;
+    QToolButton *searchButton = nullptr;
+
+    // See stats().
+    TabWidgetStats statsData;
+    QTimer *statsTimer = nullptr;
+
+    // See setMemoryReportInterval().
+    QTimer *memoryReportTimer = nullptr;
+    QString memoryReportPath;
 };
 
+template<typename Visitor>
+void TabWidgetPlus::forEachTab(Visitor visitor) const
+{
+    // Visible tabs are numbered as they are passed, so no index is
+    // looked up.
+    auto index = 0;
+    for (auto entry = registry.first(); nullptr != entry;
+            entry = registry.next(entry)) {
+        TabInfo info;
+        info.id = entry->id;
+        info.widget = entry->widget;
+        info.state = stateOf(entry);
+        info.index = entry->hidden ? -1 : index++;
+        visitor(static_cast<const TabInfo &>(info));
+    }
+}
+
 #endif // TABWIDGETPLUS_H
@@ -0,0 +1,95 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#include "tabwidgetstats.h"
+
+void TabWidgetStats::Histogram::record(quint64 nsecs)
+{
+    ++calls;
+    totalNsecs += nsecs;
+    if (nsecs > maxNsecs) {
+        maxNsecs = nsecs;
+    }
+    auto bucket = 0;
+    for (auto limit = nsecs >> 8; 0 != limit && bucket < BucketCount - 1; limit >>= 1) {
+        ++bucket;
+    }
+    ++buckets[bucket];
+}
+
+quint64 TabWidgetStats::Histogram::percentile(double fraction) const
+{
+    if (0 == calls) {
+        return 0;
+    }
+    auto wanted = static_cast<quint64>(fraction * calls);
+    quint64 seen = 0;
+    for (auto bucket = 0; bucket < BucketCount - 1; ++bucket) {
+        seen += buckets[bucket];
+        if (seen > wanted || seen == calls) {
+            return quint64(1) << (bucket + 8);
+        }
+    }
+    return maxNsecs;
+}
+
+const char *TabWidgetStats::probeName(Probe probe)
+{
+    switch (probe) {
+    case TabInserted:
+        return "tabInserted";
+    case TabRemoved:
+        return "tabRemoved";
+    case HideTab:
+        return "hideTab";
+    case ShowTab:
+        return "showTab";
+    case EventFilter:
+        return "eventFilter";
+    case ProbeCount:
+        break;
+    }
+    return "?";
+}
+
+QString TabWidgetStats::toString() const
+{
+    auto result = QString::number(tabCount) + " tabs, "
+                  + QString::number(hiddenTabCount) + " hidden\n";
+    if (!enabled) {
+        return result + "(built without TABWIDGETPLUS_STATS)\n";
+    }
+    result += "call\tcalls\tmean(us)\tp99(us)\tmax(us)\n";
+    for (auto i = 0; i < ProbeCount; ++i) {
+        const auto &histogram = probes[i];
+        auto mean = 0 == histogram.calls ? 0.0
+                    : histogram.totalNsecs / 1000.0 / histogram.calls;
+        result += QString(probeName(static_cast<Probe>(i))) + "\t"
+                  + QString::number(histogram.calls) + "\t"
+                  + QString::number(mean, 'f', 3) + "\t"
+                  + QString::number(histogram.percentile(0.99) / 1000.0, 'f', 3) + "\t"
+                  + QString::number(histogram.maxNsecs / 1000.0, 'f', 3) + "\n";
+    }
+    result += "relayouts: " + QString::number(relayouts) + "\n";
+    return result;
+}
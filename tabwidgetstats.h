@@ -0,0 +1,106 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#ifndef TABWIDGETSTATS_H
+#define TABWIDGETSTATS_H
+
+#include <QString>
+#include <QtGlobal>
+#include <chrono>
+
+/**
+ * @brief Counters and call timings collected by a TabWidgetPlus.
+ *
+ * Collection is compiled in only when TABWIDGETPLUS_STATS is defined
+ * (as bench/tabwidgetplusbench.pro does).  Without it every probe
+ * compiles to nothing, and TabWidgetPlus::stats() returns a snapshot
+ * that has only the tab counts filled in and 'enabled' set to false.
+ */
+struct TabWidgetStats {
+    // The calls that are timed, each with a Histogram of its own.
+    // EventFilter only counts the page events it acts on; the rest
+    // are turned away before the timer starts.
+    enum Probe {
+        TabInserted, TabRemoved, HideTab, ShowTab, EventFilter,
+        ProbeCount
+    };
+
+    //
+    // Call count and durations for one probe.  Bucket i counts calls
+    // that took less than 2^(i + 8) ns (256 ns, 512 ns, ... ~4 ms); the
+    // last bucket takes everything slower.
+    //
+    struct Histogram {
+        enum { BucketCount = 16 };
+        quint64 calls = 0;
+        quint64 totalNsecs = 0;
+        quint64 maxNsecs = 0;
+        quint64 buckets[BucketCount] = {};
+
+        void record(quint64 nsecs);
+
+        // Upper bound of the bucket holding the given fraction of calls
+        // (0.99 for p99), in ns.  0 if there were no calls.
+        quint64 percentile(double fraction) const;
+    };
+
+    //
+    // Times the enclosing scope into a Histogram.  The steady clock is a
+    // plain vDSO read on the platforms we care about, which keeps this
+    // cheap enough for the event filter.
+    //
+    class Timer
+    {
+    public:
+        explicit Timer(Histogram &histogram)
+            : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+        ~Timer()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            histogram.record(static_cast<quint64>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+
+    private:
+        Q_DISABLE_COPY(Timer)
+        Histogram &histogram;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    bool enabled = false;
+    Histogram probes[ProbeCount];
+
+    // Changes that made a visible tab bar lay itself out again.
+    quint64 relayouts = 0;
+
+    // Filled in when the snapshot is taken.
+    int tabCount = 0;
+    int hiddenTabCount = 0;
+
+    static const char *probeName(Probe probe);
+
+    // Plain text table of everything above, for logs and the demo.
+    QString toString() const;
+};
+
+#endif // TABWIDGETSTATS_H
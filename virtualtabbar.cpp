@@ -0,0 +1,215 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#include "virtualtabbar.h"
+#include <QEvent>
+#include <QPaintEvent>
+#include <QStyleOptionTab>
+#include <QStylePainter>
+
+VirtualTabBar::VirtualTabBar(QWidget *parent) : QTabBar(parent)
+{
+}
+
+int VirtualTabBar::virtualThreshold()
+{
+    return 256;
+}
+
+QSize VirtualTabBar::tabSizeHint(int index) const
+{
+    if (count() < virtualThreshold() || !tabIcon(index).isNull()) {
+        return QTabBar::tabSizeHint(index);
+    }
+    if (sizeCacheClosable != tabsClosable()) {
+        sizeCache.clear();
+        sizeCacheClosable = tabsClosable();
+    }
+    auto text = tabText(index);
+    auto iter = sizeCache.constFind(text);
+    if (iter != sizeCache.constEnd()) {
+        return *iter;
+    }
+
+    // Keep the cache from outgrowing the tab bar as titles churn.
+    if (sizeCache.size() > 4 * count()) {
+        sizeCache.clear();
+    }
+    auto size = QTabBar::tabSizeHint(index);
+    sizeCache.insert(text, size);
+    return size;
+}
+
+void VirtualTabBar::paintEvent(QPaintEvent *event)
+{
+    auto total = count();
+    if (total < virtualThreshold() || Qt::RightToLeft == layoutDirection()) {
+        // Right-to-left bars aren't ordered left to right, so the
+        // binary search below wouldn't hold.
+        QTabBar::paintEvent(event);
+        return;
+    }
+
+    //
+    // Tab rectangles grow along the bar, so the first tab reaching the
+    // exposed area can be found by binary search.  From there, paint
+    // until a tab starts past the far edge.  The current tab is drawn
+    // last, as QTabBar does, so it overlaps its neighbours.
+    //
+    auto vertical = verticalTabs();
+    auto exposed = event->rect();
+    auto exposedStart = vertical ? exposed.top() : exposed.left();
+    auto exposedEnd = vertical ? exposed.bottom() : exposed.right();
+
+    auto low = 0;
+    auto high = total;
+    while (low < high) {
+        auto middle = low + (high - low) / 2;
+        auto rect = tabRect(middle);
+        if ((vertical ? rect.bottom() : rect.right()) < exposedStart) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    QStylePainter painter(this);
+    auto selected = currentIndex();
+    if (drawBase()) {
+        //
+        // The base line QTabBar draws under the tabs, set up the way
+        // QTabBar sets it up.  Tabs are in order here, so the first and
+        // last give the extent of them all.
+        //
+        QStyleOptionTabBarBase base;
+        base.initFrom(this);
+        base.shape = shape();
+        base.documentMode = documentMode();
+        QStyleOptionTab overlapOption;
+        overlapOption.shape = shape();
+        auto overlap = style()->pixelMetric(QStyle::PM_TabBarBaseOverlap,
+                                            &overlapOption, this);
+        base.rect = rect();
+        switch (shape()) {
+        case QTabBar::RoundedNorth:
+        case QTabBar::TriangularNorth:
+            base.rect.setTop(height() - overlap);
+            break;
+        case QTabBar::RoundedSouth:
+        case QTabBar::TriangularSouth:
+            base.rect.setBottom(overlap - 1);
+            break;
+        case QTabBar::RoundedWest:
+        case QTabBar::TriangularWest:
+            base.rect.setLeft(width() - overlap);
+            break;
+        case QTabBar::RoundedEast:
+        case QTabBar::TriangularEast:
+            base.rect.setRight(overlap - 1);
+            break;
+        }
+        base.tabBarRect = tabRect(0).united(tabRect(total - 1));
+        if (-1 != selected) {
+            base.selectedTabRect = tabRect(selected);
+        }
+        painter.drawPrimitive(QStyle::PE_FrameTabBarBase, base);
+    }
+
+    auto selectedExposed = false;
+    for (auto index = low; index < total; ++index) {
+        auto rect = tabRect(index);
+        if ((vertical ? rect.top() : rect.left()) > exposedEnd) {
+            break;
+        }
+        if (index == selected) {
+            selectedExposed = true;
+            continue;
+        }
+        QStyleOptionTab option;
+        initStyleOption(&option, index);
+        painter.drawControl(QStyle::CE_TabBarTab, option);
+    }
+    if (selectedExposed) {
+        QStyleOptionTab option;
+        initStyleOption(&option, selected);
+        painter.drawControl(QStyle::CE_TabBarTab, option);
+    }
+}
+
+void VirtualTabBar::changeEvent(QEvent *event)
+{
+    auto type = event->type();
+    if (QEvent::FontChange == type || QEvent::StyleChange == type) {
+        sizeCache.clear();
+    }
+    QTabBar::changeEvent(event);
+}
+
+void VirtualTabBar::tabInserted(int index)
+{
+    QTabBar::tabInserted(index);
+    updateMode();
+}
+
+void VirtualTabBar::tabRemoved(int index)
+{
+    QTabBar::tabRemoved(index);
+    updateMode();
+}
+
+void VirtualTabBar::updateMode()
+{
+    auto wanted = count() >= virtualThreshold();
+    if (wanted == virtualMode) {
+        return;
+    }
+    virtualMode = wanted;
+    if (virtualMode) {
+        // Eliding labels makes QTabBar measure each one again while
+        // laying out, and expanding tabs defeats the size cache.
+        // Scroll buttons are how a bar this long is navigated.
+        savedElideMode = elideMode();
+        savedExpanding = expanding();
+        savedScrollButtons = usesScrollButtons();
+        setElideMode(Qt::ElideNone);
+        setExpanding(false);
+        setUsesScrollButtons(true);
+    } else {
+        setElideMode(savedElideMode);
+        setExpanding(savedExpanding);
+        setUsesScrollButtons(savedScrollButtons);
+    }
+}
+
+bool VirtualTabBar::verticalTabs() const
+{
+    switch (shape()) {
+    case QTabBar::RoundedWest:
+    case QTabBar::RoundedEast:
+    case QTabBar::TriangularWest:
+    case QTabBar::TriangularEast:
+        return true;
+    default:
+        return false;
+    }
+}
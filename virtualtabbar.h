@@ -0,0 +1,81 @@
+/*----------------------------------------------------------------------------
+ * MIT License
+ * Copyright (c) 2017 after5cst
+ * https://github.com/after5cst/TabWidgetPlusDemo.git
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in allcopies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ **-------------------------------------------------------------------------*/
+#ifndef VIRTUALTABBAR_H
+#define VIRTUALTABBAR_H
+
+#include <QHash>
+#include <QSize>
+#include <QTabBar>
+
+/**
+ * @brief QTabBar for very large numbers of tabs.
+ *
+ * QTabBar measures every tab label whenever it lays itself out and walks
+ * every tab when it paints.  This subclass caches tab sizes by label, so
+ * a relayout costs a hash lookup per tab instead of a font measurement,
+ * and paints only the tabs that intersect the exposed area, found by a
+ * binary search over the tab positions.
+ *
+ * Below virtualThreshold() tabs it measures, lays out and paints like
+ * QTabBar (which is cheap at that size and keeps QTabBar's drag
+ * animation).  From the threshold up it is in virtual mode:  labels are
+ * not elided, tabs don't expand to fill the bar, scroll buttons are on,
+ * and a tab being dragged is drawn in place until it is dropped.  Those
+ * three settings are put back as they were when the count drops below
+ * the threshold again, so changes made to them in virtual mode don't
+ * last.
+ */
+class VirtualTabBar : public QTabBar
+{
+    Q_OBJECT
+public:
+    explicit VirtualTabBar(QWidget *parent = 0);
+    virtual ~VirtualTabBar() = default;
+
+    static int virtualThreshold();
+
+protected:
+    QSize tabSizeHint(int index) const override;
+    void paintEvent(QPaintEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void tabInserted(int index) override;
+    void tabRemoved(int index) override;
+
+private:
+    bool verticalTabs() const;
+    void updateMode();
+
+    // Tab size by label.  Every tab shares the same font, style and
+    // close-button setting, so the label is all that tells them apart.
+    mutable QHash<QString, QSize> sizeCache;
+    mutable bool sizeCacheClosable = false;
+
+    // The settings virtual mode overrides, as they were on entering it.
+    bool virtualMode = false;
+    Qt::TextElideMode savedElideMode = Qt::ElideNone;
+    bool savedExpanding = true;
+    bool savedScrollButtons = true;
+};
+
+#endif // VIRTUALTABBAR_H